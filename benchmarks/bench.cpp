@@ -1,14 +1,35 @@
 #include "../src/batch_pricer.hpp"
+#include "../src/curves.hpp"
+#include "../src/dedup.hpp"
+#include "../src/grid.hpp"
+#include "../src/huge_page_allocator.hpp"
+#include "../src/reduction.hpp"
+#include "../src/sharded.hpp"
+#include "../src/thread_pool.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
 #include <cstdio>
+#include <cstring>
 #include <random>
+#include <thread>
 #include <vector>
 
-int main() {
-    constexpr std::size_t N = 1'000'000;
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
 
-    // Reproducible random contracts using a seeded Mersenne Twister
+/// Reproducible random contracts using a seeded Mersenne Twister.
+/// `distinct` < n repeats the first `distinct` contracts cyclically to model
+/// quote streams that carry the same contract many times.
+std::vector<Contract> make_contracts(std::size_t n, std::size_t distinct) {
     std::mt19937 rng(42);
     std::uniform_real_distribution<double> spot_dist(80.0, 120.0);
     std::uniform_real_distribution<double> strike_dist(70.0, 130.0);
@@ -17,25 +38,513 @@ int main() {
     const double r = 0.05;
 
     std::vector<Contract> contracts;
-    contracts.reserve(N);
+    contracts.reserve(n);
 
-    for (std::size_t i = 0; i < N; ++i) {
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i >= distinct) {
+            contracts.push_back(contracts[i % distinct]);
+            continue;
+        }
         const OptionType type = (i % 2 == 0) ? OptionType::CALL : OptionType::PUT;
         contracts.push_back({spot_dist(rng), strike_dist(rng), r, vol_dist(rng), T_dist(rng), type});
     }
+    return contracts;
+}
 
-    // Time only the pricing step, not data generation
-    const auto t0     = std::chrono::high_resolution_clock::now();
-    const auto prices = price_batch(contracts);
-    const auto t1     = std::chrono::high_resolution_clock::now();
+template <typename F> double time_ms(F&& f) {
+    const auto t0 = std::chrono::high_resolution_clock::now();
+    f();
+    const auto t1 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+// ---------------------------------------------------------------------------
+// Throughput: plain price_batch over 1M distinct contracts
+// ---------------------------------------------------------------------------
+void bench_throughput() {
+    constexpr std::size_t N = 1'000'000;
+    const auto contracts    = make_contracts(N, N);
 
-    const double ms               = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    // Time only the pricing step, not data generation
+    std::vector<double> prices;
+    const double ms               = time_ms([&] { prices = price_batch(contracts); });
     const double contracts_per_sec = static_cast<double>(N) / (ms / 1000.0);
 
     std::printf("Contracts priced : %zu\n", N);
     std::printf("Total time       : %.2f ms\n", ms);
     std::printf("Throughput       : %.0f contracts/sec\n", contracts_per_sec);
+}
+
+// ---------------------------------------------------------------------------
+// Dedup: price_batch vs price_batch_dedup as the repeat factor grows
+// ---------------------------------------------------------------------------
+void bench_dedup() {
+    constexpr std::size_t N = 1'000'000;
+    DedupArena arena;
+
+    std::printf("\n%-10s %12s %12s %10s\n", "repeats", "plain ms", "dedup ms", "speedup");
+    for (const std::size_t repeats : {1, 2, 4, 10, 100}) {
+        const auto contracts = make_contracts(N, N / repeats);
+
+        DedupStats stats{};
+        price_batch_dedup(contracts, arena, &stats); // warm the arena
+
+        const double plain_ms = time_ms([&] { price_batch(contracts); });
+        const double dedup_ms = time_ms([&] { price_batch_dedup(contracts, arena, &stats); });
+
+        std::printf("%-10.1f %12.2f %12.2f %9.2fx\n", stats.ratio(), plain_ms, dedup_ms,
+                    plain_ms / dedup_ms);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Reduction: deterministic blocked sum vs naive per-thread partials + atomic add.
+// The naive total's last bits depend on which thread finishes first.
+// ---------------------------------------------------------------------------
+void bench_reduction() {
+    constexpr std::size_t N = 10'000'000;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> price_dist(0.01, 50.0);
+    std::uniform_real_distribution<double> qty_dist(-1000.0, 1000.0);
+    std::vector<double> values(N);
+    for (auto& v : values) {
+        v = qty_dist(rng) * price_dist(rng);
+    }
+
+    std::printf("\n%-8s %12s %24s %12s %24s\n", "threads", "naive ms", "naive total",
+                "determ ms", "deterministic total");
+    for (const unsigned threads : {1u, 2u, 4u, 8u}) {
+        ThreadPool pool(threads);
+
+        double naive_total = 0.0;
+        const double naive_ms = time_ms([&] {
+            std::atomic<double> total{0.0};
+            constexpr std::size_t CHUNK = 1 << 16;
+            pool.parallel_for((N + CHUNK - 1) / CHUNK, [&](std::size_t c) {
+                double local = 0.0;
+                for (std::size_t i = c * CHUNK; i < std::min(N, (c + 1) * CHUNK); ++i) {
+                    local += values[i];
+                }
+                double seen = total.load(std::memory_order_relaxed);
+                while (!total.compare_exchange_weak(seen, seen + local)) {
+                }
+            });
+            naive_total = total.load();
+        });
+
+        double det_total    = 0.0;
+        const double det_ms =
+            time_ms([&] { det_total = deterministic_sum(values.data(), N, &pool); });
+
+        std::printf("%-8u %12.2f %24a %12.2f %24a\n", threads, naive_ms, naive_total, det_ms,
+                    det_total);
+    }
+}
+
+/// User-space dTLB load misses of the calling thread via perf_event_open.
+/// read() returns -1 where the counter is unavailable (non-Linux, no PMU in a VM,
+/// or perf_event_paranoid too strict).
+class DtlbMissCounter {
+  public:
+    DtlbMissCounter() {
+#ifdef __linux__
+        perf_event_attr attr{};
+        attr.size   = sizeof attr;
+        attr.type   = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~DtlbMissCounter() {
+#ifdef __linux__
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+#endif
+    }
+
+    void start() {
+#ifdef __linux__
+        if (fd_ >= 0) {
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    long long stop() {
+#ifdef __linux__
+        long long count = -1;
+        if (fd_ >= 0) {
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            if (::read(fd_, &count, sizeof count) != sizeof count) {
+                count = -1;
+            }
+        }
+        return count;
+#else
+        return -1;
+#endif
+    }
+
+  private:
+    int fd_ = -1;
+};
+
+// ---------------------------------------------------------------------------
+// Huge pages: 10M-contract SoA batch with columns on 2 MB pages vs base pages
+// ---------------------------------------------------------------------------
+void bench_hugepages() {
+    constexpr std::size_t N = 10'000'000;
+    const auto contracts    = make_contracts(N, N);
+    DtlbMissCounter tlb;
+
+    std::printf("\n%-12s %12s %16s %14s\n", "columns", "ms", "contracts/sec", "dTLB misses");
+    for (const bool huge : {false, true}) {
+        set_huge_page_columns(huge); // applies to the columns allocated below
+        ContractBatch batch;
+        batch.reserve(N);
+        for (const auto& c : contracts) {
+            batch.push_back(c);
+        }
+        Column<double> prices(N);
+
+        tlb.start();
+        const double ms        = time_ms([&] { price_batch(batch, prices); });
+        const long long misses = tlb.stop();
+
+        std::printf("%-12s %12.2f %16.0f ", huge ? "2MB pages" : "4KB pages", ms,
+                    static_cast<double>(N) / (ms / 1000.0));
+        if (misses >= 0) {
+            std::printf("%14lld\n", misses);
+        } else {
+            std::printf("%14s\n", "n/a");
+        }
+    }
+    set_huge_page_columns(true);
+}
+
+// ---------------------------------------------------------------------------
+// Streaming: plain vs prefetch + streaming-store kernel from L1-sized batches to
+// DRAM-sized ones. Columns are ~44 bytes per contract, so 1K fits L1, 16K fits L2,
+// 256K spills most L3s and 4M+ runs from DRAM.
+// ---------------------------------------------------------------------------
+void bench_streaming() {
+    constexpr std::size_t MAX_N = std::size_t{1} << 24;
+    const auto contracts        = make_contracts(MAX_N, MAX_N);
+
+    std::printf("\n%-10s %12s %12s %10s\n", "contracts", "plain ns/c", "stream ns/c", "speedup");
+    for (std::size_t n = 1024; n <= MAX_N; n *= 4) {
+        ContractBatch batch;
+        batch.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            batch.push_back(contracts[i]);
+        }
+        Column<double> prices(n);
+        const std::size_t reps = std::max<std::size_t>(1, (std::size_t{1} << 22) / n);
+
+        price_batch_plain(batch, prices); // fault in the output pages
+        const double plain_ms = time_ms([&] {
+            for (std::size_t k = 0; k < reps; ++k) {
+                price_batch_plain(batch, prices);
+            }
+        });
+        const double stream_ms = time_ms([&] {
+            for (std::size_t k = 0; k < reps; ++k) {
+                price_batch_streaming(batch, prices);
+            }
+        });
+
+        const double per = 1e6 / static_cast<double>(n * reps);
+        std::printf("%-10zu %12.2f %12.2f %9.2fx\n", n, plain_ms * per, stream_ms * per,
+                    plain_ms / stream_ms);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Degenerate rows: plain vs guarded kernel on a clean batch and on one where every
+// tenth row is expired ATM, zero-vol or far enough OTM to reach subnormal N(d)
+// ---------------------------------------------------------------------------
+void bench_degenerate() {
+    constexpr std::size_t N = 1'000'000;
+    const auto contracts    = make_contracts(N, N);
+
+    std::printf("\n%-10s %12s %12s %12s %12s\n", "batch", "plain ms", "plain bad", "guarded ms",
+                "guarded bad");
+    for (const bool dirty : {false, true}) {
+        ContractBatch batch;
+        batch.reserve(N);
+        for (std::size_t i = 0; i < N; ++i) {
+            Contract c = contracts[i];
+            if (dirty && i % 10 == 0) {
+                switch ((i / 10) % 3) {
+                case 0: c.K = c.S; c.T = 0.0; break; // ATM at expiry: 0/0 in d1
+                case 1: c.sigma = 0.0; break;
+                default: c.K = c.S * 60.0; c.sigma = 0.05; c.T = 0.02; break; // d ~ -38
+                }
+            }
+            batch.push_back(c);
+        }
+        Column<double> prices(N);
+        const auto count_bad = [&] {
+            return std::count_if(prices.begin(), prices.end(),
+                                 [](double p) { return !std::isfinite(p); });
+        };
+
+        const double plain_ms   = time_ms([&] { price_batch_plain(batch, prices); });
+        const long plain_bad    = static_cast<long>(count_bad());
+        const double guarded_ms = time_ms([&] { price_batch_guarded(batch, prices); });
+        const long guarded_bad  = static_cast<long>(count_bad());
+
+        std::printf("%-10s %12.2f %12ld %12.2f %12ld\n", dirty ? "10% bad" : "clean", plain_ms,
+                    plain_bad, guarded_ms, guarded_bad);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Grid: 1000 x 1000 (S, sigma) sweep, pointwise price_option loop vs price_grid
+// serial and on a pool
+// ---------------------------------------------------------------------------
+void bench_grid() {
+    constexpr std::size_t AXIS = 1000;
+    const Contract base{100.0, 100.0, 0.05, 0.20, 0.5, OptionType::CALL};
+    GridAxes axes;
+    for (std::size_t i = 0; i < AXIS; ++i) {
+        axes.S.push_back(50.0 + 0.1 * static_cast<double>(i));
+        axes.sigma.push_back(0.05 + 0.0005 * static_cast<double>(i));
+    }
+    std::vector<double> prices(axes.size());
+    PricingWorkspace ws;
+    ThreadPool pool;
+
+    const double loop_ms = time_ms([&] {
+        for (std::size_t s = 0; s < AXIS; ++s) {
+            for (std::size_t v = 0; v < AXIS; ++v) {
+                prices[s * AXIS + v] = price_option(axes.S[s], base.K, base.r, axes.sigma[v],
+                                                    base.T, base.option_type);
+            }
+        }
+    });
+    const double serial_ms = time_ms([&] { price_grid(base, axes, prices, ws); });
+    const double pool_ms   = time_ms([&] { price_grid(base, axes, prices, ws, &pool); });
+
+    std::printf("\n%-22s %10s\n", "1000x1000 (S, sigma)", "ms");
+    std::printf("%-22s %10.2f\n", "price_option loop", loop_ms);
+    std::printf("%-22s %10.2f\n", "price_grid serial", serial_ms);
+    std::printf("%-22s %10.2f  (%u threads)\n", "price_grid pool", pool_ms, pool.size());
+}
+
+// ---------------------------------------------------------------------------
+// Sharded: in-process price_batch vs a ShardCoordinator with 1..2x cores worker
+// processes on 4M contracts. Workers are started outside the timed region; each run
+// ships ~44 bytes per contract over the sockets and 8 bytes back.
+// ---------------------------------------------------------------------------
+void bench_sharded() {
+    constexpr std::size_t N = std::size_t{1} << 22;
+    const auto contracts    = make_contracts(N, N);
+    ContractBatch batch;
+    batch.reserve(N);
+    for (const Contract& c : contracts) {
+        batch.push_back(c);
+    }
+    Column<double> prices(N);
+
+    const double local_ms = time_ms([&] { price_batch(batch, prices); });
+    std::printf("\n%-10s %10s %12s %9s\n", "workers", "ms", "contracts/s", "scaling");
+    std::printf("%-10s %10.2f %12.0f %9s\n", "in-proc", local_ms, N / (local_ms / 1e3), "-");
+
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    double base_ms       = 0.0;
+    for (unsigned w = 1; w <= 2 * cores; w *= 2) {
+        ShardOptions options;
+        options.workers = w;
+        ShardCoordinator coordinator(options);
+        coordinator.price_batch(batch, prices); // warm: fault in worker buffers
+
+        const double ms = time_ms([&] { coordinator.price_batch(batch, prices); });
+        base_ms         = w == 1 ? ms : base_ms;
+        std::printf("%-10u %10.2f %12.0f %8.2fx\n", w, ms, N / (ms / 1e3), base_ms / ms);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Latency: small price_batch calls (1-100 contracts) split across a 2-4 thread pool,
+// condition-variable (BLOCK) vs busy-poll (SPIN) workers, against pricing inline.
+// Reports median and p99 per call; SPIN only pays off with a core per worker.
+// ---------------------------------------------------------------------------
+void bench_latency() {
+    constexpr std::size_t CALLS = 20'000;
+    const auto contracts        = make_contracts(100, 100);
+    ContractBatch batch;
+    for (const Contract& c : contracts) {
+        batch.push_back(c);
+    }
+    Column<double> prices(batch.size());
+    std::vector<double> samples(CALLS);
+
+    const auto measure = [&](ThreadPool* pool, std::size_t n, double& p50, double& p99) {
+        const BatchView view  = BatchView(batch).slice(0, n);
+        const std::size_t tasks = pool == nullptr ? 1 : std::min<std::size_t>(n, pool->size());
+        const auto call = [&] {
+            if (pool == nullptr) {
+                price_batch(view, Span<double>(prices).subspan(0, n));
+                return;
+            }
+            pool->parallel_for(tasks, [&](std::size_t t) {
+                const std::size_t begin = n * t / tasks;
+                const std::size_t end   = n * (t + 1) / tasks;
+                price_batch(view.slice(begin, end - begin),
+                            Span<double>(prices).subspan(begin, end - begin));
+            });
+        };
+        for (std::size_t k = 0; k < CALLS / 10; ++k) {
+            call(); // warm up
+        }
+        for (std::size_t k = 0; k < CALLS; ++k) {
+            const auto t0 = std::chrono::steady_clock::now();
+            call();
+            samples[k] = std::chrono::duration<double, std::micro>(
+                             std::chrono::steady_clock::now() - t0)
+                             .count();
+        }
+        std::sort(samples.begin(), samples.end());
+        p50 = samples[CALLS / 2];
+        p99 = samples[CALLS * 99 / 100];
+    };
+
+    PoolOptions block_opts;
+    block_opts.threads = std::max(2u, std::min(4u, std::thread::hardware_concurrency()));
+    PoolOptions spin_opts = block_opts;
+    spin_opts.wait        = PoolWait::SPIN;
+    PoolOptions pin_opts  = spin_opts;
+    pin_opts.pin          = true;
+    ThreadPool block(block_opts);
+
+    std::printf("\n%-10s %-10s %10s %10s   (us per call, %u threads, %u cores)\n", "contracts",
+                "mode", "p50", "p99", block.size(), std::thread::hardware_concurrency());
+    for (const std::size_t n : {std::size_t{1}, std::size_t{10}, std::size_t{100}}) {
+        double p50 = 0.0;
+        double p99 = 0.0;
+        measure(nullptr, n, p50, p99);
+        std::printf("%-10zu %-10s %10.2f %10.2f\n", n, "inline", p50, p99);
+        measure(&block, n, p50, p99);
+        std::printf("%-10zu %-10s %10.2f %10.2f\n", n, "block", p50, p99);
+        {
+            ThreadPool spin(spin_opts); // spinning workers live only while measured
+            measure(&spin, n, p50, p99);
+        }
+        std::printf("%-10zu %-10s %10.2f %10.2f\n", n, "spin", p50, p99);
+        {
+            ThreadPool pinned(pin_opts);
+            measure(&pinned, n, p50, p99);
+        }
+        std::printf("%-10zu %-10s %10.2f %10.2f\n", n, "spin+pin", p50, p99);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Curves: 1M contracts priced off a 12-pillar rate curve and a 4-pillar dividend curve,
+// either by materialising per-row r and dividend-adjusted S columns first (what the
+// Python scripts did) or in one pass with price_batch_curves; random vs expiry-sorted
+// rows shows what the segment hint saves on the lookups.
+// ---------------------------------------------------------------------------
+void bench_curves() {
+    constexpr std::size_t N = 1'000'000;
+    const auto contracts    = make_contracts(N, N);
+    ContractBatch random;
+    random.reserve(N);
+    for (const Contract& c : contracts) {
+        random.push_back(c);
+    }
+    auto by_expiry = contracts;
+    std::sort(by_expiry.begin(), by_expiry.end(),
+              [](const Contract& a, const Contract& b) { return a.T < b.T; });
+    ContractBatch sorted;
+    sorted.reserve(N);
+    for (const Contract& c : by_expiry) {
+        sorted.push_back(c);
+    }
+
+    const YieldCurve rates({1.0 / 12, 2.0 / 12, 0.25, 0.5, 0.75, 1.0, 1.5, 2.0, 3.0, 5.0,
+                            7.0, 10.0},
+                           {0.053, 0.052, 0.051, 0.049, 0.047, 0.046, 0.044, 0.043, 0.042,
+                            0.041, 0.041, 0.042});
+    const DividendCurve dividends({0.25, 1.0, 2.0, 5.0}, {0.012, 0.013, 0.0135, 0.014});
+    Column<double> prices(N);
+    Column<double> scratch(N);
+
+    std::printf("\n%-30s %10s %10s\n", "1M contracts", "random ms", "sorted ms");
+    const auto row = [](const char* name, double a, double b) {
+        std::printf("%-30s %10.2f %10.2f\n", name, a, b);
+    };
+    const auto lookup = [&](const ContractBatch& b) {
+        return time_ms([&] { rates.zero_rate(b.T, scratch); });
+    };
+    row("zero_rate lookup", lookup(random), lookup(sorted));
+
+    const auto materialised = [&](const ContractBatch& b) {
+        ContractBatch adjusted = b;
+        return time_ms([&] {
+            rates.zero_rate(b.T, adjusted.r);
+            dividends.discount(b.T, scratch);
+            for (std::size_t i = 0; i < N; ++i) {
+                adjusted.S[i] = b.S[i] * scratch[i];
+            }
+            price_batch(adjusted, prices);
+        });
+    };
+    row("columns + price_batch", materialised(random), materialised(sorted));
+
+    const auto one_pass = [&](const ContractBatch& b) {
+        return time_ms([&] { price_batch_curves(b, rates, dividends, prices); });
+    };
+    row("price_batch_curves", one_pass(random), one_pass(sorted));
+}
+
+} // namespace
 
-    (void)prices; // suppress unused-variable warning
+/// Usage: bench [throughput|dedup|reduction|hugepages|streaming|degenerate|grid|sharded|
+///               latency|curves]
+/// (no argument runs everything)
+int main(int argc, char** argv) {
+    const char* which = argc > 1 ? argv[1] : nullptr;
+    const auto selected = [which](const char* name) {
+        return which == nullptr || std::strcmp(which, name) == 0;
+    };
+
+    if (selected("throughput")) {
+        bench_throughput();
+    }
+    if (selected("dedup")) {
+        bench_dedup();
+    }
+    if (selected("reduction")) {
+        bench_reduction();
+    }
+    if (selected("hugepages")) {
+        bench_hugepages();
+    }
+    if (selected("streaming")) {
+        bench_streaming();
+    }
+    if (selected("degenerate")) {
+        bench_degenerate();
+    }
+    if (selected("grid")) {
+        bench_grid();
+    }
+    if (selected("sharded")) {
+        bench_sharded();
+    }
+    if (selected("latency")) {
+        bench_latency();
+    }
+    if (selected("curves")) {
+        bench_curves();
+    }
     return 0;
 }
@@ -0,0 +1,90 @@
+"""
+Prices from many Python threads at once and reports how throughput scales.
+
+On the free-threaded CPython build (3.13t+) the module runs without a GIL, so both
+the scalar API and the batch API can scale with threads; how far depends on the
+machine and interpreter, which is what this script measures. On a regular build only
+the batch API can scale, because batch calls release the GIL while pricing; scalar
+calls spend most of their time in the interpreter.
+
+Usage:
+    python3 bench_threads.py [--threads 1 2 4 8] [--batch 200000] [--scalar 200000]
+"""
+
+import argparse
+import os
+import sys
+import sysconfig
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+
+# Allow running from the python/ directory directly
+sys.path.insert(0, os.path.dirname(__file__))
+import options_pricer as op
+
+
+def make_batch(n: int, seed: int) -> "op.ContractBatch":
+    rng = np.random.default_rng(seed)
+    batch = op.ContractBatch()
+    batch.extend(
+        S=rng.uniform(80, 120, n),
+        K=rng.uniform(70, 130, n),
+        r=0.05,
+        sigma=rng.uniform(0.1, 0.5, n),
+        T=rng.uniform(0.1, 2.0, n),
+        option_type=np.arange(n) % 2,  # 0 = CALL, 1 = PUT
+    )
+    return batch
+
+
+def batch_work(batch: "op.ContractBatch") -> int:
+    op.price_batch(batch)
+    return len(batch)
+
+
+def scalar_work(n: int) -> int:
+    price = op.price_option
+    call = op.OptionType.CALL
+    for i in range(n):
+        price(100.0, 80.0 + (i % 40), 0.05, 0.2, 1.0, call)
+    return n
+
+
+def run(threads: int, work, args) -> float:
+    """Contracts per second with `threads` threads each running work(*args)."""
+    with ThreadPoolExecutor(max_workers=threads) as pool:
+        start = time.perf_counter()
+        done = sum(pool.map(lambda _: work(*args), range(threads)))
+        elapsed = time.perf_counter() - start
+    return done / elapsed
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("--threads", type=int, nargs="+", default=[1, 2, 4, 8])
+    parser.add_argument("--batch", type=int, default=200_000, help="contracts per batch call")
+    parser.add_argument("--scalar", type=int, default=200_000, help="scalar calls per thread")
+    args = parser.parse_args()
+
+    gil = getattr(sys, "_is_gil_enabled", lambda: True)()
+    print(f"Python {sys.version.split()[0]}  "
+          f"free-threaded build: {bool(sysconfig.get_config_var('Py_GIL_DISABLED'))}  "
+          f"GIL enabled: {gil}")
+
+    batch = make_batch(args.batch, seed=42)
+    batch_work(batch)  # warm per-thread scratch and page in the columns
+
+    base_batch = base_scalar = None
+    print(f"\n{'threads':>8} {'batch c/s':>14} {'scaling':>8} {'scalar c/s':>14} {'scaling':>8}")
+    for t in args.threads:
+        b = run(t, batch_work, (batch,))
+        s = run(t, scalar_work, (args.scalar,))
+        base_batch = base_batch or b
+        base_scalar = base_scalar or s
+        print(f"{t:>8} {b:>14,.0f} {b / base_batch:>7.2f}x {s:>14,.0f} {s / base_scalar:>7.2f}x")
+
+
+if __name__ == "__main__":
+    main()
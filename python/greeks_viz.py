@@ -25,34 +25,20 @@ T     = 0.5
 
 S_range = np.linspace(60, 140, 500)
 
-# Accumulate Greeks for each spot price
-call_delta, put_delta   = [], []
-gamma_vals              = []   # identical for call and put
-vega_vals               = []   # identical for call and put
-call_theta, put_theta   = [], []
-
-for s in S_range:
-    cg = op.compute_greeks(S=s, K=K, r=r, sigma=sigma, T=T,
-                           option_type=op.OptionType.CALL)
-    pg = op.compute_greeks(S=s, K=K, r=r, sigma=sigma, T=T,
-                           option_type=op.OptionType.PUT)
-
-    call_delta.append(cg.delta)
-    put_delta.append(pg.delta)
-
-    gamma_vals.append(cg.gamma)      # same for both
-    vega_vals.append(cg.vega * 100)  # convert to textbook vega (per unit σ)
-
-    # Theta: C++ returns annualised; divide by 365 for per-calendar-day
-    call_theta.append(cg.theta / 365.0)
-    put_theta.append(pg.theta / 365.0)
-
-call_delta  = np.array(call_delta)
-put_delta   = np.array(put_delta)
-gamma_vals  = np.array(gamma_vals)
-vega_vals   = np.array(vega_vals)
-call_theta  = np.array(call_theta)
-put_theta   = np.array(put_theta)
+# One native call per option type evaluates the whole spot axis
+call = op.Contract(S=K, K=K, r=r, sigma=sigma, T=T, option_type=op.OptionType.CALL)
+put  = op.Contract(S=K, K=K, r=r, sigma=sigma, T=T, option_type=op.OptionType.PUT)
+cg = op.greeks_grid(call, S=S_range)
+pg = op.greeks_grid(put,  S=S_range)
+
+call_delta  = cg["delta"]
+put_delta   = pg["delta"]
+gamma_vals  = cg["gamma"]          # identical for call and put
+vega_vals   = cg["vega"] * 100     # convert to textbook vega (per unit σ)
+
+# Theta: C++ returns annualised; divide by 365 for per-calendar-day
+call_theta  = cg["theta"] / 365.0
+put_theta   = pg["theta"] / 365.0
 
 ATM_LINE_KW = dict(color="grey", linestyle="--", linewidth=1.2,
                    label="ATM (K=100)")
@@ -1,8 +1,9 @@
 """
 Plots the implied volatility surface as a 2D heatmap across strike and expiry.
 
-Fetches live option chain data from Yahoo Finance, computes IV per strike/expiry
-via Newton-Raphson, and plots a pcolormesh where colour encodes IV (%).
+Fetches live option chain data from Yahoo Finance, hands the raw chains to the native
+op.iv_surface (filtering, IV solve, put/call merge and strike join, expiries solved in
+parallel), and plots a pcolormesh where colour encodes IV (%).
 
 Usage:
     python3 iv_surface.py [--ticker TICKER]
@@ -19,7 +20,6 @@ import yfinance as yf
 
 sys.path.insert(0, os.path.dirname(__file__))
 import options_pricer as op
-from implied_vol import implied_vol
 
 # Liquidity / filtering constants (same as volatility_smile.py)
 MAX_SPREAD_RATIO = 0.50
@@ -67,46 +67,9 @@ def select_expiries(ticker_obj) -> list[tuple[str, int]]:
     return result
 
 
-def compute_ivs_for_expiry(
-    chain_df, spot: float, T: float, option_type: op.OptionType
-) -> dict[float, float]:
-    """
-    Compute IV (decimal) per strike for one expiry/option-type combination.
-
-    Applies liquidity filters and ±STRIKE_BAND strike window.
-    Returns {strike: iv_decimal}.
-    """
-    low  = spot * (1.0 - STRIKE_BAND)
-    high = spot * (1.0 + STRIKE_BAND)
-    ivs  = {}
-
-    for _, row in chain_df.iterrows():
-        strike = float(row["strike"])
-        bid    = float(row["bid"])
-        ask    = float(row["ask"])
-
-        if bid <= 0 or ask <= 0:
-            continue
-        if (ask - bid) / ask > MAX_SPREAD_RATIO:
-            continue
-        if not (low <= strike <= high):
-            continue
-
-        mid = (bid + ask) / 2.0
-        try:
-            iv = implied_vol(
-                market_price=mid,
-                S=spot,
-                K=strike,
-                r=RISK_FREE_RATE,
-                T=T,
-                option_type=option_type,
-            )
-            ivs[strike] = iv
-        except ValueError:
-            continue
-
-    return ivs
+def side_arrays(chain_df) -> tuple[np.ndarray, np.ndarray, np.ndarray]:
+    """(strikes, bids, asks) of one side of a yfinance chain as float64 arrays."""
+    return tuple(chain_df[col].to_numpy(dtype=float) for col in ("strike", "bid", "ask"))
 
 
 def main() -> None:
@@ -138,76 +101,50 @@ def main() -> None:
 
     today = datetime.today().date()
 
-    # Collect IV dicts per expiry: {expiry_str: {strike: iv}}
-    expiry_iv_maps: list[tuple[int, dict[float, float]]] = []
-
+    # Raw chains per expiry; everything from filtering to the dense grid runs natively.
+    chains, labels = [], []
     for exp_str, days in expiries:
         T = (datetime.strptime(exp_str, "%Y-%m-%d").date() - today).days / 365.0
         if T <= 0:
             continue
-
         chain = stock.option_chain(exp_str)
+        chains.append((T, side_arrays(chain.calls), side_arrays(chain.puts)))
+        labels.append((exp_str, days))
+
+    surface = op.iv_surface(
+        spot, chains,
+        max_spread_ratio=MAX_SPREAD_RATIO,
+        strike_band=STRIKE_BAND,
+        r=RISK_FREE_RATE,
+    )
 
-        # Use calls for OTM calls (strike > spot) and puts for OTM puts (strike < spot)
-        call_ivs = compute_ivs_for_expiry(chain.calls, spot, T, op.OptionType.CALL)
-        put_ivs  = compute_ivs_for_expiry(chain.puts,  spot, T, op.OptionType.PUT)
-
-        # Merge: prefer put IV below spot, call IV above (standard surface convention)
-        merged: dict[float, float] = {}
-        for k, v in put_ivs.items():
-            if k <= spot:
-                merged[k] = v
-        for k, v in call_ivs.items():
-            if k > spot:
-                merged[k] = v
-        # Fill any gaps with whichever side has data
-        for k, v in call_ivs.items():
-            if k not in merged:
-                merged[k] = v
-        for k, v in put_ivs.items():
-            if k not in merged:
-                merged[k] = v
-
-        if merged:
-            expiry_iv_maps.append((days, merged))
-            print(f"  {exp_str} ({days}d): {len(merged)} liquid strikes")
+    for (exp_str, days), liquid in zip(labels, surface["quoted"]):
+        if liquid:
+            print(f"  {exp_str} ({days}d): {liquid} liquid strikes")
         else:
             print(f"  {exp_str} ({days}d): no liquid data — skipped")
 
-    if len(expiry_iv_maps) < MIN_EXPIRIES:
+    if len(surface["T"]) < MIN_EXPIRIES:
         print(
-            f"Warning: only {len(expiry_iv_maps)} expiry/ies have liquid data "
+            f"Warning: only {len(surface['T'])} expiry/ies have liquid data "
             f"(need at least {MIN_EXPIRIES}). "
             "Check market hours or choose a more liquid ticker."
         )
         sys.exit(1)
 
-    # Inner join: strikes present in ALL expiries
-    strike_sets = [set(iv_map.keys()) for _, iv_map in expiry_iv_maps]
-    common_strikes = sorted(strike_sets[0].intersection(*strike_sets[1:]))
-
-    if len(common_strikes) < 3:
+    strikes_arr = surface["strikes"]
+    if len(strikes_arr) < 3:
         print(
-            f"Warning: only {len(common_strikes)} common strike(s) across all expiries. "
+            f"Warning: only {len(strikes_arr)} common strike(s) across all expiries. "
             "Try a more liquid ticker or re-run during market hours."
         )
         sys.exit(1)
 
-    # Sort expiry rows ascending by days-to-expiry
-    expiry_iv_maps.sort(key=lambda x: x[0])
-    expiry_days_list = [days for days, _ in expiry_iv_maps]
-
-    print(f"\nBuilding {len(expiry_days_list)}×{len(common_strikes)} IV grid...")
-
-    # Build 2D grid: rows = expiries, cols = strikes, values = IV %
-    iv_grid = np.full((len(expiry_days_list), len(common_strikes)), np.nan)
-    for i, (_, iv_map) in enumerate(expiry_iv_maps):
-        for j, strike in enumerate(common_strikes):
-            if strike in iv_map:
-                iv_grid[i, j] = iv_map[strike] * 100.0  # decimal -> %
+    # Rows come back sorted by T; map each to its days-to-expiry label
+    days_arr = np.array([labels[i][1] for i in surface["expiry"]])
+    iv_grid  = surface["iv"] * 100.0  # decimal -> %
 
-    strikes_arr = np.array(common_strikes)
-    days_arr    = np.array(expiry_days_list)
+    print(f"\nBuilt {len(days_arr)}×{len(strikes_arr)} IV grid")
 
     # --- Plot ---
     fig, ax = plt.subplots(figsize=(12, 5))
@@ -0,0 +1,242 @@
+#include "arena.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+inline std::size_t round_up(std::size_t n, std::size_t multiple) {
+    return (n + multiple - 1) / multiple * multiple;
+}
+
+inline std::size_t base_page_size() {
+    static const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    return page;
+}
+
+void* map_anonymous(std::size_t bytes, int extra_flags) {
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | extra_flags,
+                   -1, 0);
+    return p == MAP_FAILED ? nullptr : p;
+}
+
+/// Base-page mapping whose start is HUGE_PAGE_SIZE aligned, so the kernel can back it
+/// with transparent huge pages: over-map by one huge page and trim both ends.
+void* map_huge_aligned(std::size_t bytes) {
+    const std::size_t padded = bytes + HUGE_PAGE_SIZE;
+    auto* raw                = static_cast<char*>(map_anonymous(padded, 0));
+    if (raw == nullptr) {
+        return nullptr;
+    }
+    const auto addr        = reinterpret_cast<std::uintptr_t>(raw);
+    const std::size_t head = round_up(addr, HUGE_PAGE_SIZE) - addr;
+    const std::size_t tail = padded - head - bytes;
+    char* aligned          = raw + head;
+    if (head > 0) {
+        munmap(raw, head);
+    }
+    if (tail > 0) {
+        munmap(aligned + bytes, tail);
+    }
+    return aligned;
+}
+
+} // namespace
+
+std::size_t mapped_bytes(std::size_t bytes) {
+    return bytes < HUGE_PAGE_SIZE ? round_up(std::max<std::size_t>(bytes, 1), base_page_size())
+                                  : round_up(bytes, HUGE_PAGE_SIZE);
+}
+
+PageBlock map_pages(std::size_t bytes, bool huge) {
+    bytes = mapped_bytes(bytes);
+    if (bytes < HUGE_PAGE_SIZE) {
+        void* p = map_anonymous(bytes, 0);
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return PageBlock{p, bytes, PageKind::REGULAR};
+    }
+
+    if (!huge) {
+        void* p = map_anonymous(bytes, 0);
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+#ifdef MADV_NOHUGEPAGE
+        madvise(p, bytes, MADV_NOHUGEPAGE);
+#endif
+        return PageBlock{p, bytes, PageKind::REGULAR};
+    }
+
+#ifdef MAP_HUGETLB
+    // Succeeds only if the administrator reserved huge pages (vm.nr_hugepages).
+    if (void* p = map_anonymous(bytes, MAP_HUGETLB)) {
+        return PageBlock{p, bytes, PageKind::HUGETLB};
+    }
+#endif
+    void* p = map_huge_aligned(bytes);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+#ifdef MADV_HUGEPAGE
+    if (madvise(p, bytes, MADV_HUGEPAGE) == 0) {
+        return PageBlock{p, bytes, PageKind::THP_ADVISED};
+    }
+#endif
+    return PageBlock{p, bytes, PageKind::REGULAR};
+}
+
+void unmap_pages(const PageBlock& block) {
+    if (block.data != nullptr) {
+        munmap(block.data, block.bytes);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// MonotonicArena
+// ---------------------------------------------------------------------------
+
+MonotonicArena::MonotonicArena(std::size_t initial_chunk_bytes)
+    : next_chunk_bytes_(std::max<std::size_t>(initial_chunk_bytes, 4096)) {}
+
+MonotonicArena::~MonotonicArena() {
+    for (const PageBlock& c : chunks_) {
+        unmap_pages(c);
+    }
+}
+
+void* MonotonicArena::allocate(std::size_t bytes, std::size_t align) {
+    ++stats_.allocations;
+
+    // Walk forward through already-mapped chunks before asking the OS for more.
+    for (; current_ < chunks_.size(); ++current_, offset_ = 0) {
+        const PageBlock& c      = chunks_[current_];
+        const auto base         = reinterpret_cast<std::uintptr_t>(c.data);
+        const std::size_t start = round_up(base + offset_, align) - base;
+        if (start + bytes <= c.bytes) {
+            stats_.bytes_in_use += start + bytes - offset_;
+            stats_.peak_bytes_in_use = std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+            offset_                  = start + bytes;
+            return static_cast<char*>(c.data) + start;
+        }
+        stats_.bytes_in_use += c.bytes - offset_; // the unused tail is skipped until reset
+    }
+
+    // Geometric growth keeps the chunk count logarithmic in the peak footprint.
+    const std::size_t want = std::max(next_chunk_bytes_, bytes + align);
+    const PageBlock c      = map_pages(want);
+    chunks_.push_back(c);
+    next_chunk_bytes_ = std::max(next_chunk_bytes_ * 2, c.bytes);
+    stats_.bytes_reserved += c.bytes;
+    if (c.kind != PageKind::REGULAR) {
+        stats_.huge_page_bytes += c.bytes;
+    }
+
+    current_                = chunks_.size() - 1;
+    const auto base         = reinterpret_cast<std::uintptr_t>(c.data);
+    const std::size_t start = round_up(base, align) - base;
+    offset_                 = start + bytes;
+    stats_.bytes_in_use += offset_;
+    stats_.peak_bytes_in_use = std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+    return static_cast<char*>(c.data) + start;
+}
+
+void MonotonicArena::rewind(const Marker& m) {
+    current_            = m.chunk;
+    offset_             = m.offset;
+    stats_.bytes_in_use = m.in_use;
+    ++stats_.resets;
+}
+
+MonotonicArena& thread_arena() {
+    thread_local MonotonicArena arena;
+    return arena;
+}
+
+// ---------------------------------------------------------------------------
+// SizeClassPool
+// ---------------------------------------------------------------------------
+
+namespace {
+
+/// Index of the smallest class holding `bytes` (16 B -> 0, ..., 4 KB -> 8).
+inline std::size_t class_index(std::size_t bytes) {
+    std::size_t cls  = 0;
+    std::size_t size = SizeClassPool::MIN_CLASS;
+    while (size < bytes) {
+        size <<= 1;
+        ++cls;
+    }
+    return cls;
+}
+
+inline std::size_t class_size(std::size_t cls) { return SizeClassPool::MIN_CLASS << cls; }
+
+} // namespace
+
+SizeClassPool::~SizeClassPool() {
+    for (const PageBlock& s : slabs_) {
+        unmap_pages(s);
+    }
+}
+
+void* SizeClassPool::allocate(std::size_t bytes) {
+    if (bytes > MAX_CLASS) {
+        ++stats_.oversize;
+        return ::operator new(bytes);
+    }
+
+    const std::size_t cls = class_index(bytes);
+    if (free_[cls] == nullptr) {
+        refill(cls);
+    }
+    FreeBlock* b = free_[cls];
+    free_[cls]   = b->next;
+
+    ++stats_.allocations;
+    stats_.bytes_in_use += class_size(cls);
+    stats_.peak_bytes_in_use = std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+    return b;
+}
+
+void SizeClassPool::deallocate(void* p, std::size_t bytes) {
+    if (p == nullptr) {
+        return;
+    }
+    if (bytes > MAX_CLASS) {
+        ::operator delete(p);
+        return;
+    }
+
+    const std::size_t cls = class_index(bytes);
+    auto* b               = static_cast<FreeBlock*>(p);
+    b->next               = free_[cls];
+    free_[cls]            = b;
+    stats_.bytes_in_use -= class_size(cls);
+}
+
+void SizeClassPool::refill(std::size_t cls) {
+    const PageBlock slab = map_pages(SLAB_BYTES);
+    slabs_.push_back(slab);
+    stats_.bytes_reserved += slab.bytes;
+
+    // Thread the slab onto the free list back to front so blocks are handed out in
+    // address order.
+    const std::size_t size = class_size(cls);
+    char* base             = static_cast<char*>(slab.data);
+    for (std::size_t off = slab.bytes / size * size; off >= size; off -= size) {
+        auto* b    = reinterpret_cast<FreeBlock*>(base + off - size);
+        b->next    = free_[cls];
+        free_[cls] = b;
+    }
+}
+
+SizeClassPool& thread_size_class_pool() {
+    thread_local SizeClassPool pool;
+    return pool;
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Page-level backing
+// ---------------------------------------------------------------------------
+
+/// Huge page size assumed for large mappings (x86-64 and arm64 Linux default).
+constexpr std::size_t HUGE_PAGE_SIZE = std::size_t{2} << 20;
+
+/// How a PageBlock is backed by the OS.
+enum class PageKind {
+    REGULAR,     ///< Ordinary base pages
+    HUGETLB,     ///< Explicit huge pages (MAP_HUGETLB), from the reserved pool
+    THP_ADVISED, ///< Base-page mapping, 2 MB aligned and madvise(MADV_HUGEPAGE)'d
+};
+
+/// A block of anonymous memory obtained straight from the OS.
+struct PageBlock {
+    void* data;
+    std::size_t bytes;
+    PageKind kind;
+};
+
+/// Map at least `bytes` of zeroed memory. Requests of HUGE_PAGE_SIZE or more are
+/// rounded up to whole huge pages and try MAP_HUGETLB first, then fall back to an
+/// aligned mapping advised for transparent huge pages. With `huge` false, large
+/// mappings are advised MADV_NOHUGEPAGE instead (for A/B measurements).
+/// Throws std::bad_alloc.
+PageBlock map_pages(std::size_t bytes, bool huge = true);
+
+/// Size map_pages actually maps for a request of `bytes`.
+std::size_t mapped_bytes(std::size_t bytes);
+
+void unmap_pages(const PageBlock& block);
+
+// ---------------------------------------------------------------------------
+// Monotonic arena
+// ---------------------------------------------------------------------------
+
+struct ArenaStats {
+    std::size_t bytes_reserved;    ///< Mapped from the OS (all chunks)
+    std::size_t huge_page_bytes;   ///< Part of bytes_reserved backed by huge pages
+    std::size_t bytes_in_use;      ///< Handed out since the last reset, incl. alignment
+    std::size_t peak_bytes_in_use; ///< High-water mark of bytes_in_use
+    std::uint64_t allocations;     ///< allocate() calls
+    std::uint64_t resets;          ///< reset() / rewind() calls
+};
+
+/// Bump allocator for short-lived engine state (tree lattices, PDE grids, path blocks).
+/// Allocation is a pointer bump; individual frees do not exist. reset() or rewind()
+/// releases everything at once and keeps the chunks mapped for the next valuation.
+/// Not thread-safe: use one arena per thread (see thread_arena()).
+class MonotonicArena {
+  public:
+    /// Position to rewind to; see mark() / rewind().
+    struct Marker {
+        std::size_t chunk;
+        std::size_t offset;
+        std::size_t in_use;
+    };
+
+    explicit MonotonicArena(std::size_t initial_chunk_bytes = 64 << 10);
+    ~MonotonicArena();
+
+    MonotonicArena(const MonotonicArena&)            = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    /// Uninitialized storage of `bytes` aligned to `align` (a power of two).
+    void* allocate(std::size_t bytes, std::size_t align = alignof(std::max_align_t));
+
+    /// Uninitialized storage for n objects of T.
+    template <typename T> T* allocate_array(std::size_t n) {
+        return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+    Marker mark() const { return Marker{current_, offset_, stats_.bytes_in_use}; }
+
+    /// Release everything allocated after `m`.
+    void rewind(const Marker& m);
+
+    /// Release everything; chunks stay mapped.
+    void reset() { rewind(Marker{0, 0, 0}); }
+
+    const ArenaStats& stats() const { return stats_; }
+
+  private:
+    std::vector<PageBlock> chunks_;
+    std::size_t current_ = 0; ///< Chunk being bumped
+    std::size_t offset_  = 0; ///< Bytes used in the current chunk
+    std::size_t next_chunk_bytes_;
+    ArenaStats stats_{};
+};
+
+/// The calling thread's arena. Engines draw per-valuation scratch from it inside an
+/// ArenaScope.
+MonotonicArena& thread_arena();
+
+/// Rewinds an arena to where it was on construction; one per valuation.
+class ArenaScope {
+  public:
+    explicit ArenaScope(MonotonicArena& arena = thread_arena())
+        : arena_(arena), marker_(arena.mark()) {}
+    ~ArenaScope() { arena_.rewind(marker_); }
+
+    ArenaScope(const ArenaScope&)            = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+  private:
+    MonotonicArena& arena_;
+    MonotonicArena::Marker marker_;
+};
+
+/// std-compatible allocator drawing from a MonotonicArena; deallocate is a no-op.
+/// Lets engines build std::vector scratch that disappears with the ArenaScope.
+template <typename T> struct ArenaAllocator {
+    using value_type = T;
+
+    MonotonicArena* arena;
+
+    explicit ArenaAllocator(MonotonicArena& a = thread_arena()) : arena(&a) {}
+    template <typename U> ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(std::size_t n) { return arena->allocate_array<T>(n); }
+    void deallocate(T*, std::size_t) {}
+
+    template <typename U> bool operator==(const ArenaAllocator<U>& o) const {
+        return arena == o.arena;
+    }
+    template <typename U> bool operator!=(const ArenaAllocator<U>& o) const {
+        return arena != o.arena;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Size-class pool
+// ---------------------------------------------------------------------------
+
+struct PoolStats {
+    std::size_t bytes_reserved;    ///< Slab memory mapped from the OS
+    std::size_t bytes_in_use;      ///< Live blocks, rounded up to their size class
+    std::size_t peak_bytes_in_use; ///< High-water mark of bytes_in_use
+    std::uint64_t allocations;     ///< Served from a size class
+    std::uint64_t oversize;        ///< Larger than the biggest class; sent to operator new
+};
+
+/// Free-list pool for small objects that outlive a single bump region (nodes, per-contract
+/// state). Sizes round up to a power-of-two class from 16 B to 4 KB; each class carves
+/// blocks from 64 KB slabs and recycles freed blocks LIFO, so hot blocks stay cached.
+/// Not thread-safe: use one pool per thread (see thread_size_class_pool()).
+class SizeClassPool {
+  public:
+    static constexpr std::size_t MIN_CLASS   = 16;
+    static constexpr std::size_t MAX_CLASS   = 4096;
+    static constexpr std::size_t NUM_CLASSES = 9; ///< 16, 32, ..., 4096
+    static constexpr std::size_t SLAB_BYTES  = 64 << 10;
+
+    SizeClassPool() = default;
+    ~SizeClassPool();
+
+    SizeClassPool(const SizeClassPool&)            = delete;
+    SizeClassPool& operator=(const SizeClassPool&) = delete;
+
+    void* allocate(std::size_t bytes);
+
+    /// `bytes` must be the size passed to allocate().
+    void deallocate(void* p, std::size_t bytes);
+
+    const PoolStats& stats() const { return stats_; }
+
+  private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    void refill(std::size_t cls);
+
+    FreeBlock* free_[NUM_CLASSES] = {};
+    std::vector<PageBlock> slabs_;
+    PoolStats stats_{};
+};
+
+/// The calling thread's size-class pool.
+SizeClassPool& thread_size_class_pool();
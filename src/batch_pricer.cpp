@@ -1,14 +1,231 @@
 #include "batch_pricer.hpp"
 
 #include "black_scholes.hpp"
+#include "fp_env.hpp"
 
-std::vector<double> price_batch(const std::vector<Contract>& contracts) {
-    std::vector<double> prices;
-    prices.reserve(contracts.size()); // avoid repeated reallocations over 1M+ iterations
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+void ContractBatch::reserve(std::size_t n) {
+    S.reserve(n);
+    K.reserve(n);
+    r.reserve(n);
+    sigma.reserve(n);
+    T.reserve(n);
+    option_type.reserve(n);
+}
+
+void ContractBatch::clear() {
+    S.clear();
+    K.clear();
+    r.clear();
+    sigma.clear();
+    T.clear();
+    option_type.clear();
+}
+
+void ContractBatch::push_back(const Contract& c) {
+    S.push_back(c.S);
+    K.push_back(c.K);
+    r.push_back(c.r);
+    sigma.push_back(c.sigma);
+    T.push_back(c.T);
+    option_type.push_back(c.option_type);
+}
+
+BatchView::BatchView(Span<const double> S, Span<const double> K, Span<const double> r,
+                     Span<const double> sigma, Span<const double> T,
+                     Span<const OptionType> option_type)
+    : S(S), K(K), r(r), sigma(sigma), T(T), option_type(option_type) {
+    const std::size_t n = S.size();
+    if (K.size() != n || r.size() != n || sigma.size() != n || T.size() != n ||
+        option_type.size() != n) {
+        throw std::invalid_argument("BatchView: column lengths differ");
+    }
+}
+
+BatchView::BatchView(const ContractBatch& batch)
+    : S(batch.S), K(batch.K), r(batch.r), sigma(batch.sigma), T(batch.T),
+      option_type(batch.option_type) {}
+
+BatchView BatchView::slice(std::size_t offset, std::size_t count) const {
+    if (offset > size() || count > size() - offset) {
+        throw std::out_of_range("BatchView::slice: rows [" + std::to_string(offset) + ", " +
+                                std::to_string(offset + count) + ") exceed size " +
+                                std::to_string(size()));
+    }
+    BatchView v;
+    v.S           = S.subspan(offset, count);
+    v.K           = K.subspan(offset, count);
+    v.r           = r.subspan(offset, count);
+    v.sigma       = sigma.subspan(offset, count);
+    v.T           = T.subspan(offset, count);
+    v.option_type = option_type.subspan(offset, count);
+    return v;
+}
+
+namespace {
+
+constexpr std::size_t CACHE_LINE      = 64;
+constexpr std::size_t BLOCK           = CACHE_LINE / sizeof(double); ///< Contracts per block
+constexpr std::size_t PREFETCH_BLOCKS = 8; ///< How far ahead to prefetch (~8 lines/column)
+
+inline void prefetch(const void* p) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p, 0 /* read */, 0 /* no temporal locality */);
+#else
+    (void)p;
+#endif
+}
+
+/// Write one cache line of prices, bypassing the cache where the ISA allows it.
+/// `dst` must be CACHE_LINE aligned.
+inline void store_line(double* dst, const double* src) {
+#ifdef __SSE2__
+    for (std::size_t j = 0; j < BLOCK; j += 2) {
+        _mm_stream_pd(dst + j, _mm_load_pd(src + j));
+    }
+#else
+    std::memcpy(dst, src, CACHE_LINE);
+#endif
+}
+
+/// Order streaming stores before anything the caller does next.
+inline void streaming_fence() {
+#ifdef __SSE2__
+    _mm_sfence();
+#endif
+}
+
+void check_output(std::size_t inputs, std::size_t outputs, const char* fn) {
+    if (inputs != outputs) {
+        throw std::invalid_argument(std::string(fn) + ": output span length " +
+                                    std::to_string(outputs) + " != batch size " +
+                                    std::to_string(inputs));
+    }
+}
+
+} // namespace
+
+void price_batch(Span<const Contract> contracts, Span<double> prices) {
+    check_output(contracts.size(), prices.size(), "price_batch");
+
+    for (std::size_t i = 0; i < contracts.size(); ++i) {
+        const Contract& c = contracts[i];
+        prices[i]         = price_option(c.S, c.K, c.r, c.sigma, c.T, c.option_type);
+    }
+}
+
+void price_batch(const BatchView& batch, Span<double> prices) {
+    if (batch.size() >= STREAMING_THRESHOLD) {
+        price_batch_streaming(batch, prices);
+    } else {
+        price_batch_plain(batch, prices);
+    }
+}
+
+void price_batch_plain(const BatchView& batch, Span<double> prices) {
+    const std::size_t n = batch.size();
+    check_output(n, prices.size(), "price_batch");
+
+    for (std::size_t i = 0; i < n; ++i) {
+        prices[i] = price_option(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i],
+                                 batch.option_type[i]);
+    }
+}
+
+void price_batch_guarded(const BatchView& batch, Span<double> prices) {
+    const std::size_t n = batch.size();
+    check_output(n, prices.size(), "price_batch_guarded");
+
+    ScopedFlushDenormals ftz;
+    for (std::size_t i = 0; i < n; ++i) {
+        prices[i] = price_option_guarded(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i],
+                                         batch.T[i], batch.option_type[i]);
+    }
+}
+
+void price_batch_streaming(const BatchView& batch, Span<double> prices) {
+    const std::size_t n = batch.size();
+    check_output(n, prices.size(), "price_batch_streaming");
+
+    double* out = prices.data();
+    std::size_t i = 0;
+
+    // Scalar head until the output is cache-line aligned, so every streaming store in the
+    // main loop writes a full line and no partially written line is read back.
+    while (i < n && reinterpret_cast<std::uintptr_t>(out + i) % CACHE_LINE != 0) {
+        out[i] = price_option(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i],
+                              batch.option_type[i]);
+        ++i;
+    }
+
+    for (; i + BLOCK <= n; i += BLOCK) {
+        const std::size_t ahead = i + PREFETCH_BLOCKS * BLOCK;
+        if (ahead < n) {
+            prefetch(&batch.S[ahead]);
+            prefetch(&batch.K[ahead]);
+            prefetch(&batch.r[ahead]);
+            prefetch(&batch.sigma[ahead]);
+            prefetch(&batch.T[ahead]);
+            prefetch(&batch.option_type[ahead]); // 4-byte enums: one line covers two blocks
+        }
+
+        alignas(CACHE_LINE) double block[BLOCK];
+        for (std::size_t j = 0; j < BLOCK; ++j) {
+            const std::size_t k = i + j;
+            block[j] = price_option(batch.S[k], batch.K[k], batch.r[k], batch.sigma[k],
+                                    batch.T[k], batch.option_type[k]);
+        }
+        store_line(out + i, block);
+    }
 
-    for (const auto& c : contracts) {
-        prices.push_back(price_option(c.S, c.K, c.r, c.sigma, c.T, c.option_type));
+    for (; i < n; ++i) {
+        out[i] = price_option(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i],
+                              batch.option_type[i]);
     }
 
+    streaming_fence();
+}
+
+void greeks_batch(Span<const Contract> contracts, Span<Greeks> greeks) {
+    check_output(contracts.size(), greeks.size(), "greeks_batch");
+
+    for (std::size_t i = 0; i < contracts.size(); ++i) {
+        const Contract& c = contracts[i];
+        greeks[i]         = compute_greeks(c.S, c.K, c.r, c.sigma, c.T, c.option_type);
+    }
+}
+
+void greeks_batch(const BatchView& batch, Span<Greeks> greeks) {
+    const std::size_t n = batch.size();
+    check_output(n, greeks.size(), "greeks_batch");
+
+    for (std::size_t i = 0; i < n; ++i) {
+        greeks[i] = compute_greeks(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i],
+                                   batch.T[i], batch.option_type[i]);
+    }
+}
+
+std::vector<double> price_batch(const std::vector<Contract>& contracts) {
+    std::vector<double> prices(contracts.size());
+    price_batch(contracts, prices);
+    return prices;
+}
+
+Column<double> price_batch(const ContractBatch& batch) {
+    Column<double> prices(batch.size());
+    price_batch(batch, prices);
     return prices;
 }
+
+std::vector<Greeks> greeks_batch(const std::vector<Contract>& contracts) {
+    std::vector<Greeks> greeks(contracts.size());
+    greeks_batch(contracts, greeks);
+    return greeks;
+}
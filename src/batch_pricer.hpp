@@ -1,7 +1,11 @@
 #pragma once
 
 #include "black_scholes.hpp"
+#include "huge_page_allocator.hpp"
+#include "span.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 /// All parameters needed to price a single option contract.
@@ -14,6 +18,100 @@ struct Contract {
     OptionType option_type; ///< CALL or PUT
 };
 
+/// Structure-of-arrays contract batch: one contiguous column per input, so the batch
+/// kernel streams each column sequentially instead of striding over Contract records.
+/// Columns use HugePageAllocator, so large batches sit on 2 MB pages.
+struct ContractBatch {
+    Column<double> S;
+    Column<double> K;
+    Column<double> r;
+    Column<double> sigma;
+    Column<double> T;
+    Column<OptionType> option_type;
+
+    std::size_t size() const { return S.size(); }
+    void reserve(std::size_t n);
+    void clear();
+    void push_back(const Contract& c);
+
+    /// Row i as an AoS record, for engines that take Span<const Contract>.
+    Contract row(std::size_t i) const { return {S[i], K[i], r[i], sigma[i], T[i], option_type[i]}; }
+};
+
+/// Non-owning view of SoA contract columns: a whole ContractBatch, a slice of one, or
+/// columns that live outside any ContractBatch (e.g. a SharedBatch mapping). The SoA
+/// kernels take a view, so every source of columns runs the same loops. A ContractBatch
+/// converts implicitly, as std::string does to std::string_view.
+struct BatchView {
+    Span<const double> S;
+    Span<const double> K;
+    Span<const double> r;
+    Span<const double> sigma;
+    Span<const double> T;
+    Span<const OptionType> option_type;
+
+    BatchView() = default;
+    BatchView(Span<const double> S, Span<const double> K, Span<const double> r,
+              Span<const double> sigma, Span<const double> T,
+              Span<const OptionType> option_type);
+    BatchView(const ContractBatch& batch);
+
+    std::size_t size() const { return S.size(); }
+
+    /// Rows [offset, offset + count).
+    BatchView slice(std::size_t offset, std::size_t count) const;
+
+    Contract row(std::size_t i) const { return {S[i], K[i], r[i], sigma[i], T[i], option_type[i]}; }
+};
+
 /// Price a batch of contracts using the Black-Scholes formula.
+/// Writes prices[i] for contracts[i]; never allocates.
+/// Throws std::invalid_argument if the spans differ in length.
+void price_batch(Span<const Contract> contracts, Span<double> prices);
+
+/// Batch size from which price_batch(ContractBatch) switches to the streaming kernel.
+/// The kernel is compute-bound (exp/log/erfc per row), so prefetching buys little; the
+/// point is that at 4M contracts the 32 MB output column would otherwise flush the LLC.
+/// Below this the two kernels measure within noise of each other (`bench streaming`).
+constexpr std::size_t STREAMING_THRESHOLD = std::size_t{1} << 22;
+
+/// Price an SoA batch (or view) into prices (row order); never allocates.
+/// Dispatches to price_batch_streaming at STREAMING_THRESHOLD contracts and above.
+/// Throws std::invalid_argument if prices.size() != batch.size().
+void price_batch(const BatchView& batch, Span<double> prices);
+
+/// Batch kernel for inputs that may contain expired, zero-vol or far-from-the-money rows.
+/// Each row goes through price_option_guarded (branch-free intrinsic fallback, clamped
+/// d1/d2) with denormals flushed to zero for the duration of the call, so a handful of
+/// pathological rows neither stall the batch nor write NaN/inf into prices. Rows with a
+/// NaN input still price to NaN.
+void price_batch_guarded(const BatchView& batch, Span<double> prices);
+
+/// Straight loop over the SoA columns; best while the batch is cache resident.
+void price_batch_plain(const BatchView& batch, Span<double> prices);
+
+/// Large-batch kernel: works in cache-line blocks of 8 contracts, prefetches every input
+/// column a few blocks ahead, and writes prices with non-temporal (streaming) stores so
+/// the output column does not evict inputs still to be read. Streaming stores are used
+/// on x86 SSE2; elsewhere it falls back to normal stores and keeps the prefetching.
+void price_batch_streaming(const BatchView& batch, Span<double> prices);
+
+/// Analytical Greeks for a batch of contracts into greeks; never allocates.
+/// Throws std::invalid_argument if the spans differ in length.
+void greeks_batch(Span<const Contract> contracts, Span<Greeks> greeks);
+
+/// Analytical Greeks for an SoA batch into greeks (row order); never allocates.
+/// Throws std::invalid_argument if greeks.size() != batch.size().
+void greeks_batch(const BatchView& batch, Span<Greeks> greeks);
+
+/// Allocating convenience form of price_batch.
 /// Returns prices in the same order as the input vector.
 std::vector<double> price_batch(const std::vector<Contract>& contracts);
+
+/// Allocating convenience form of price_batch for an SoA batch.
+/// The result is a huge-page backed Column like the inputs.
+Column<double> price_batch(const ContractBatch& batch);
+
+/// Allocating convenience form of greeks_batch.
+/// Returns Greeks in the same order as the input vector.
+std::vector<Greeks> greeks_batch(const std::vector<Contract>& contracts);
@@ -1,13 +1,301 @@
 #include "batch_pricer.hpp"
 #include "black_scholes.hpp"
+#include "curves.hpp"
+#include "dedup.hpp"
+#include "dividends.hpp"
+#include "eod_risk.hpp"
+#include "grid.hpp"
+#include "price_cache.hpp"
+#include "pricing_graph.hpp"
+#include "projection.hpp"
+#include "risk_aggregator.hpp"
+#include "shared_batch.hpp"
+#include "strategy.hpp"
+#include "vol_surface.hpp"
+#include "warm_state.hpp"
+#ifdef OPTIONS_PRICER_UFUNCS
+#include "ufuncs.hpp"
+#endif
 
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h> // required for automatic std::vector <-> list conversion
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
 
 namespace py = pybind11;
 
-PYBIND11_MODULE(options_pricer, m) {
+namespace {
+
+/// Python passes contracts as a list of Contract; the SoA engines take a ContractBatch.
+ContractBatch to_batch(const std::vector<Contract>& contracts) {
+    ContractBatch batch;
+    batch.reserve(contracts.size());
+    for (const auto& c : contracts) {
+        batch.push_back(c);
+    }
+    return batch;
+}
+
+using DoubleArray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+using TypeArray   = py::array_t<std::int32_t, py::array::c_style | py::array::forcecast>;
+
+// ContractBatch.option_type is exposed as an int32 view of the enum column.
+static_assert(sizeof(OptionType) == sizeof(std::int32_t), "OptionType must be 32-bit");
+
+/// ContractBatch as bound to Python: the columns plus the number of live NumPy views
+/// into them. A resize would leave those views pointing at freed memory, so while any
+/// exists the mutators raise BufferError, as bytearray does for its buffer exports.
+/// `mutex` is held exclusively by the mutators and shared by everything that reads the
+/// columns (pricing calls, view creation), so threads can share a batch without a GIL.
+struct BoundBatch : ContractBatch {
+    std::atomic<std::size_t> views{0};
+    mutable std::shared_mutex mutex;
+
+    /// Called first by every method that can reallocate or shrink the columns.
+    void check_resizable(const char* method) const {
+        if (views.load(std::memory_order_acquire) != 0) {
+            throw py::buffer_error(std::string("ContractBatch.") + method +
+                                   ": cannot resize while column views exist");
+        }
+    }
+};
+
+using ReadLock  = std::shared_lock<std::shared_mutex>;
+using WriteLock = std::unique_lock<std::shared_mutex>;
+
+/// Lock `batch` from a thread that holds the GIL. Waiting happens with the GIL released:
+/// a thread holding the batch lock may need the GIL back before it unlocks (regular
+/// CPython), so a waiter must never keep it. Entry points that already run without the
+/// GIL lock batch.mutex directly.
+template <typename Lock> Lock lock_batch(const BoundBatch& batch) {
+    Lock lock(batch.mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        py::gil_scoped_release release;
+        lock.lock();
+    }
+    return lock;
+}
+
+/// Base object of BoundBatch column views: holds the batch and counts as one export
+/// until NumPy releases the last array sharing the view's memory.
+struct ViewLease {
+    py::object owner;
+    BoundBatch* batch;
+
+    explicit ViewLease(py::object self)
+        : owner(std::move(self)), batch(&owner.cast<BoundBatch&>()) {
+        batch->views.fetch_add(1, std::memory_order_acq_rel);
+    }
+    ~ViewLease() { batch->views.fetch_sub(1, std::memory_order_acq_rel); }
+};
+
+/// Zero-copy 1-D NumPy view of a batch column, with `owner` as its base so the batch
+/// outlives the view.
+template <typename View, typename T> py::array column_view(Column<T>& column, py::handle owner) {
+    return py::array_t<View>({static_cast<py::ssize_t>(column.size())},
+                             {static_cast<py::ssize_t>(sizeof(T))},
+                             reinterpret_cast<View*>(column.data()), owner);
+}
+
+/// Zero-copy 1-D NumPy view of a column that does not live in a Column (e.g. a
+/// SharedBatch mapping), with `owner` as its base.
+template <typename View, typename T> py::array column_view(Span<T> column, py::handle owner) {
+    return py::array_t<View>({static_cast<py::ssize_t>(column.size())},
+                             {static_cast<py::ssize_t>(sizeof(T))},
+                             reinterpret_cast<View*>(column.data()), owner);
+}
+
+/// Property getter exposing batch member `column` through column_view<View>, leased so
+/// the batch refuses to resize while the view is alive.
+template <typename View, typename T> auto column_property(Column<T> ContractBatch::*column) {
+    return [column](py::object self) {
+        const ReadLock lock = lock_batch<ReadLock>(self.cast<const BoundBatch&>());
+        // The capsule owns the lease once constructed; until then a throw must not leak it,
+        // or the batch would refuse to resize for the rest of its life.
+        auto lease        = std::make_unique<ViewLease>(std::move(self));
+        BoundBatch* batch = lease->batch;
+        py::capsule base(lease.get(), [](void* p) { delete static_cast<ViewLease*>(p); });
+        lease.release();
+        return column_view<View>(batch->*column, base);
+    };
+}
+
+/// Property getter exposing SharedBatch column accessor `column` through column_view<View>.
+template <typename View, typename T>
+auto shared_column_property(Span<T> (SharedBatch::*column)() const) {
+    return [column](py::object self) {
+        return column_view<View>((self.cast<const SharedBatch&>().*column)(), self);
+    };
+}
+
+/// Common length of extend() inputs: each is a 1-D array of n values or a scalar.
+std::size_t broadcast_length(std::initializer_list<py::array> columns) {
+    std::size_t n = 1;
+    for (const auto& c : columns) {
+        if (c.ndim() > 1) {
+            throw py::value_error("ContractBatch.extend: columns must be 1-D");
+        }
+        const auto size = static_cast<std::size_t>(c.size());
+        if (size != 1 && n != 1 && size != n) {
+            throw py::value_error("ContractBatch.extend: column lengths differ");
+        }
+        n = size != 1 ? size : n;
+    }
+    return n;
+}
+
+/// Element i of an extend() input, or its only element for a broadcast scalar.
+template <typename T, int Flags>
+inline T broadcast_at(const py::array_t<T, Flags>& a, std::size_t i) {
+    return a.size() == 1 ? a.data()[0] : a.data()[i];
+}
+
+/// AoS copy of a batch for engines that take Span<const Contract>, in a per-thread buffer.
+const std::vector<Contract>& batch_rows(const ContractBatch& batch) {
+    static thread_local std::vector<Contract> rows;
+    rows.clear();
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        rows.push_back(batch.row(i));
+    }
+    return rows;
+}
+
+/// Copy an optional NumPy sweep axis into `axis` and append its extent to `dims`.
+/// Absent axes stay empty, which GridAxes treats as "hold the base value".
+void take_axis(const std::optional<DoubleArray>& values, const char* name,
+               std::vector<double>& axis, std::vector<py::ssize_t>& dims) {
+    if (!values) {
+        return;
+    }
+    if (values->ndim() != 1 || values->size() == 0) {
+        throw py::value_error(std::string("grid axis ") + name + " must be a non-empty 1-D array");
+    }
+    axis.assign(values->data(), values->data() + values->size());
+    dims.push_back(values->size());
+}
+
+/// One side of an iv_surface() chain: a (strikes, bids, asks) tuple of 1-D arrays.
+/// The converted arrays are appended to `keep` so the spans stay valid for the call.
+ChainSide take_side(py::handle side, std::vector<DoubleArray>& keep) {
+    const auto columns = side.cast<py::sequence>();
+    if (columns.size() != 3) {
+        throw py::value_error("iv_surface: each side must be (strikes, bids, asks)");
+    }
+    Span<const double> spans[3];
+    for (std::size_t k = 0; k < 3; ++k) {
+        keep.push_back(DoubleArray::ensure(columns[k]));
+        const DoubleArray& a = keep.back();
+        if (!a || a.ndim() != 1) {
+            throw py::value_error("iv_surface: strikes, bids and asks must be 1-D arrays");
+        }
+        spans[k] = Span<const double>(a.data(), static_cast<std::size_t>(a.size()));
+    }
+    if (spans[1].size() != spans[0].size() || spans[2].size() != spans[0].size()) {
+        throw py::value_error("iv_surface: strikes, bids and asks of a side differ in length");
+    }
+    return ChainSide{spans[0], spans[1], spans[2]};
+}
+
+/// 1-D NumPy copy of a std::vector.
+template <typename T> py::array_t<T> vector_array(const std::vector<T>& values) {
+    return py::array_t<T>(static_cast<py::ssize_t>(values.size()), values.data());
+}
+
+/// IvSurface as the dict iv_surface() returns: strikes, T, expiry, quoted and a
+/// (len(T), len(strikes)) iv grid.
+py::dict surface_dict(const IvSurface& surface) {
+    py::array_t<double> iv({static_cast<py::ssize_t>(surface.T.size()),
+                            static_cast<py::ssize_t>(surface.strikes.size())});
+    std::copy(surface.iv.begin(), surface.iv.end(), iv.mutable_data());
+    py::dict result;
+    result["strikes"] = vector_array(surface.strikes);
+    result["T"]       = vector_array(surface.T);
+    result["expiry"]  = vector_array(surface.expiry);
+    result["quoted"]  = vector_array(surface.quoted);
+    result["iv"]      = iv;
+    return result;
+}
+
+/// Inverse of surface_dict, for surfaces handed back from Python.
+IvSurface surface_from_dict(const py::dict& d) {
+    const auto take = [&](const char* key, auto& out) {
+        using T      = typename std::decay_t<decltype(out)>::value_type;
+        using Array  = py::array_t<T, py::array::c_style | py::array::forcecast>;
+        const auto a = Array::ensure(py::object(d[key]));
+        if (!a) {
+            throw py::value_error(std::string("surface dict: bad or missing '") + key + "'");
+        }
+        out.assign(a.data(), a.data() + a.size());
+    };
+    IvSurface surface;
+    take("strikes", surface.strikes);
+    take("T", surface.T);
+    take("expiry", surface.expiry);
+    take("quoted", surface.quoted);
+    take("iv", surface.iv);
+    return surface;
+}
+
+/// Pool shared by the grid and surface entry points. A caller that finds it busy runs
+/// its chunks inline, so concurrent Python threads don't queue behind each other.
+ThreadPool& grid_pool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+// greeks_grid writes Valuation records straight into a (..., 5) float64 array.
+static_assert(sizeof(Greeks) == 4 * sizeof(double),
+              "Greeks must be four packed doubles: delta, gamma, vega, theta");
+static_assert(std::is_standard_layout<Valuation>::value &&
+                  sizeof(Valuation) == 5 * sizeof(double),
+              "Valuation must be five packed doubles: price, delta, gamma, vega, theta");
+
+// ---------------------------------------------------------------------------
+// Free-threaded CPython: the module is declared GIL-free, so any bound object can be
+// called from several threads at once. Module-level state is limited to the grid pool
+// (a busy pool runs callers' tasks inline) and thread_local scratch; PricingCache is
+// lock-free by design. PricingGraph and RiskAggregator are single-writer engines, so
+// their Python types wrap them with a per-instance mutex. ContractBatch (BoundBatch)
+// carries a reader/writer lock: appends and clears are exclusive, pricing calls shared.
+// ---------------------------------------------------------------------------
+
+/// A single-threaded engine plus the mutex that serializes Python calls into it.
+template <typename Engine> struct Locked : Engine {
+    using Engine::Engine;
+    std::mutex mutex;
+};
+
+/// Bind a member function of Engine as a method of Locked<Engine> that holds the mutex.
+/// Results are returned by value, so references into the engine never outlive the lock.
+template <typename Engine, typename R, typename... Args>
+auto locked(R (Engine::*fn)(Args...)) {
+    return [fn](Locked<Engine>& self, Args... args) -> std::decay_t<R> {
+        std::lock_guard<std::mutex> lock(self.mutex);
+        return (self.*fn)(args...);
+    };
+}
+template <typename Engine, typename R, typename... Args>
+auto locked(R (Engine::*fn)(Args...) const) {
+    return [fn](Locked<Engine>& self, Args... args) -> std::decay_t<R> {
+        std::lock_guard<std::mutex> lock(self.mutex);
+        return (self.*fn)(args...);
+    };
+}
+
+} // namespace
+
+PYBIND11_MODULE(options_pricer, m, py::mod_gil_not_used()) {
     m.doc() = "Black-Scholes options pricing engine with analytical Greeks.";
 
     // --- OptionType enum ---
@@ -49,6 +337,163 @@ PYBIND11_MODULE(options_pricer, m) {
         .def_readwrite("T", &Contract::T, "Time to expiry in years.")
         .def_readwrite("option_type", &Contract::option_type, "CALL or PUT.");
 
+    // --- SoA contract batch with zero-copy NumPy column views ---
+    // Mutators raise BufferError while column views exist (see BoundBatch).
+    py::class_<BoundBatch>(m, "ContractBatch")
+        .def(py::init<>())
+        .def("__len__",
+             [](const BoundBatch& b) {
+                 const ReadLock lock = lock_batch<ReadLock>(b);
+                 return b.size();
+             })
+        .def("__getitem__",
+             [](const BoundBatch& b, std::size_t i) {
+                 const ReadLock lock = lock_batch<ReadLock>(b);
+                 if (i >= b.size()) {
+                     throw py::index_error("ContractBatch index out of range");
+                 }
+                 return b.row(i);
+             })
+        .def("reserve",
+             [](BoundBatch& b, std::size_t n) {
+                 const WriteLock lock = lock_batch<WriteLock>(b);
+                 b.check_resizable("reserve");
+                 b.reserve(n);
+             },
+             py::arg("n"), "Reserve capacity for n rows.")
+        .def("clear",
+             [](BoundBatch& b) {
+                 const WriteLock lock = lock_batch<WriteLock>(b);
+                 b.check_resizable("clear");
+                 b.clear();
+             })
+        .def("append",
+             [](BoundBatch& b, const Contract& contract) {
+                 const WriteLock lock = lock_batch<WriteLock>(b);
+                 b.check_resizable("append");
+                 b.push_back(contract);
+             },
+             py::arg("contract"), "Append one Contract.")
+        .def("extend",
+             [](BoundBatch& b, const DoubleArray& S, const DoubleArray& K, const DoubleArray& r,
+                const DoubleArray& sigma, const DoubleArray& T, const TypeArray& option_type) {
+                 const WriteLock lock = lock_batch<WriteLock>(b);
+                 b.check_resizable("extend");
+                 const std::size_t n = broadcast_length({S, K, r, sigma, T, option_type});
+                 for (std::size_t i = 0; i < n; ++i) {
+                     const std::int32_t code = broadcast_at(option_type, i);
+                     if (code != static_cast<std::int32_t>(OptionType::CALL) &&
+                         code != static_cast<std::int32_t>(OptionType::PUT)) {
+                         throw py::value_error("ContractBatch.extend: option_type must be "
+                                               "OptionType or 0 = CALL, 1 = PUT");
+                     }
+                 }
+                 if (b.S.capacity() < b.size() + n) {
+                     b.reserve(std::max(2 * b.S.capacity(), b.size() + n));
+                 }
+                 for (std::size_t i = 0; i < n; ++i) {
+                     b.push_back({broadcast_at(S, i), broadcast_at(K, i), broadcast_at(r, i),
+                                  broadcast_at(sigma, i), broadcast_at(T, i),
+                                  static_cast<OptionType>(broadcast_at(option_type, i))});
+                 }
+             },
+             py::arg("S"), py::arg("K"), py::arg("r"), py::arg("sigma"), py::arg("T"),
+             py::arg("option_type"),
+             "Append rows from NumPy arrays (or scalars, broadcast to the common length).")
+        .def_property_readonly("S", column_property<double>(&ContractBatch::S),
+                               "Spot column as a writable NumPy view (no copy).")
+        .def_property_readonly("K", column_property<double>(&ContractBatch::K),
+                               "Strike column as a writable NumPy view (no copy).")
+        .def_property_readonly("r", column_property<double>(&ContractBatch::r),
+                               "Rate column as a writable NumPy view (no copy).")
+        .def_property_readonly("sigma", column_property<double>(&ContractBatch::sigma),
+                               "Volatility column as a writable NumPy view (no copy).")
+        .def_property_readonly("T", column_property<double>(&ContractBatch::T),
+                               "Expiry column as a writable NumPy view (no copy).")
+        .def_property_readonly("option_type",
+                               column_property<std::int32_t>(&ContractBatch::option_type),
+                               "Option-type column as a writable int32 view (0 = CALL, 1 = PUT).");
+
+    // --- Shared-memory batches for multiprocessing workers ---
+    // A handle pickles as (name, rows); a SharedBatch pickles as its handle and unpickles
+    // by attaching, so either can be passed to a worker process without copying rows.
+    py::class_<SharedBatchHandle>(m, "SharedBatchHandle")
+        .def(py::init([](std::string name, std::size_t rows) {
+                 return SharedBatchHandle{std::move(name), rows};
+             }),
+             py::arg("name"), py::arg("rows"))
+        .def_readonly("name", &SharedBatchHandle::name, "Shared-memory segment name.")
+        .def_readonly("rows", &SharedBatchHandle::rows, "Row count the segment must have.")
+        .def("__repr__",
+             [](const SharedBatchHandle& h) {
+                 return "SharedBatchHandle(name='" + h.name + "', rows=" +
+                        std::to_string(h.rows) + ")";
+             })
+        .def(py::pickle(
+            [](const SharedBatchHandle& h) { return py::make_tuple(h.name, h.rows); },
+            [](const py::tuple& t) {
+                return SharedBatchHandle{t[0].cast<std::string>(), t[1].cast<std::size_t>()};
+            }));
+
+    py::class_<SharedBatch>(m, "SharedBatch")
+        .def_static("create",
+                    [](const std::string& name, const BoundBatch& batch) {
+                        const ReadLock lock = lock_batch<ReadLock>(batch);
+                        return SharedBatch::create(name, batch);
+                    },
+                    py::arg("name"), py::arg("batch"),
+                    "Create a named segment holding a copy of a ContractBatch. The creating "
+                    "object unlinks the name when it is garbage collected.")
+        .def_static("create",
+                    py::overload_cast<const std::string&, std::size_t>(&SharedBatch::create),
+                    py::arg("name"), py::arg("rows"),
+                    "Create a zero-filled named segment of `rows` rows; fill it through "
+                    "the column views.")
+        .def_static("attach",
+                    py::overload_cast<const SharedBatchHandle&>(&SharedBatch::attach),
+                    py::arg("handle"), "Map an existing segment by handle (no copy).")
+        .def_static("attach", py::overload_cast<const std::string&>(&SharedBatch::attach),
+                    py::arg("name"), "Map an existing segment by name (no copy).")
+        .def("__len__", &SharedBatch::size)
+        .def_property_readonly("name", &SharedBatch::name)
+        .def_property_readonly("handle", &SharedBatch::handle,
+                               "Picklable handle for SharedBatch.attach in another process.")
+        .def_property_readonly("owner", &SharedBatch::owner,
+                               "True for the creating object, which unlinks the name.")
+        .def("unlink", &SharedBatch::unlink,
+             "Remove the segment name now; existing mappings stay valid.")
+        .def("price_rows", &SharedBatch::price_rows,
+             py::call_guard<py::gil_scoped_release>(), py::arg("begin"), py::arg("end"),
+             "Price rows [begin, end) into the shared prices buffer.")
+        .def("greeks_rows", &SharedBatch::greeks_rows,
+             py::call_guard<py::gil_scoped_release>(), py::arg("begin"), py::arg("end"),
+             "Compute Greeks for rows [begin, end) into the shared greeks buffer.")
+        .def_property_readonly("S", shared_column_property<double>(&SharedBatch::S))
+        .def_property_readonly("K", shared_column_property<double>(&SharedBatch::K))
+        .def_property_readonly("r", shared_column_property<double>(&SharedBatch::r))
+        .def_property_readonly("sigma", shared_column_property<double>(&SharedBatch::sigma))
+        .def_property_readonly("T", shared_column_property<double>(&SharedBatch::T))
+        .def_property_readonly("option_type",
+                               shared_column_property<std::int32_t>(&SharedBatch::option_type),
+                               "Option-type column as an int32 view (0 = CALL, 1 = PUT).")
+        .def_property_readonly("prices", shared_column_property<double>(&SharedBatch::prices),
+                               "Shared result buffer written by price_rows.")
+        .def_property_readonly(
+            "greeks",
+            [](py::object self) {
+                const Span<Greeks> g = self.cast<const SharedBatch&>().greeks();
+                return py::array_t<double>(
+                    {static_cast<py::ssize_t>(g.size()), py::ssize_t{4}},
+                    reinterpret_cast<double*>(g.data()), self);
+            },
+            "Shared (rows, 4) result buffer of delta, gamma, vega, theta written by "
+            "greeks_rows.")
+        .def(py::pickle([](const SharedBatch& b) { return py::make_tuple(b.name(), b.size()); },
+                        [](const py::tuple& t) {
+                            return SharedBatch::attach(SharedBatchHandle{
+                                t[0].cast<std::string>(), t[1].cast<std::size_t>()});
+                        }));
+
     // --- Free functions ---
     m.def("price_option", &price_option,
           py::arg("S"), py::arg("K"), py::arg("r"), py::arg("sigma"),
@@ -60,7 +505,579 @@ PYBIND11_MODULE(options_pricer, m) {
           py::arg("T"), py::arg("option_type"),
           "Compute analytical Black-Scholes Greeks for a European option.");
 
-    m.def("price_batch", &price_batch,
+    // ContractBatch overloads are registered first so a batch never falls through to
+    // the list forms (which would copy it row by row).
+    m.def("price_batch",
+          [](const BoundBatch& batch) {
+              const ReadLock lock = lock_batch<ReadLock>(batch);
+              py::array_t<double> prices(static_cast<py::ssize_t>(batch.size()));
+              double* out = prices.mutable_data();
+              {
+                  py::gil_scoped_release release;
+                  price_batch(batch, Span<double>(out, batch.size()));
+              }
+              return prices;
+          },
+          py::arg("batch"), "Price a ContractBatch. Returns a NumPy array in row order.");
+
+    m.def("price_batch", py::overload_cast<const std::vector<Contract>&>(&price_batch),
+          py::call_guard<py::gil_scoped_release>(),
           py::arg("contracts"),
           "Price a list of Contract objects. Returns a list of prices in the same order.");
+
+    m.def("greeks_batch",
+          [](const BoundBatch& batch) {
+              const ReadLock lock = lock_batch<ReadLock>(batch);
+              py::array_t<double> records({static_cast<py::ssize_t>(batch.size()), py::ssize_t{4}});
+              auto* out = reinterpret_cast<Greeks*>(records.mutable_data());
+              {
+                  py::gil_scoped_release release;
+                  greeks_batch(batch, Span<Greeks>(out, batch.size()));
+              }
+              py::dict result;
+              const char* names[] = {"delta", "gamma", "vega", "theta"};
+              for (py::ssize_t k = 0; k < 4; ++k) {
+                  result[names[k]] = py::object(records[py::make_tuple(py::ellipsis(), k)]);
+              }
+              return result;
+          },
+          py::arg("batch"),
+          "Greeks of a ContractBatch as a dict of NumPy arrays (delta, gamma, vega, theta).");
+
+    m.def("greeks_batch", py::overload_cast<const std::vector<Contract>&>(&greeks_batch),
+          py::call_guard<py::gil_scoped_release>(),
+          py::arg("contracts"),
+          "Compute Greeks for a list of Contract objects. Returns a list in the same order.");
+
+    // --- Multi-leg strategies ---
+    py::class_<Leg>(m, "Leg")
+        .def(py::init([](std::size_t contract_id, double quantity) {
+                 return Leg{contract_id, quantity};
+             }),
+             py::arg("contract_id"), py::arg("quantity"),
+             "A signed position in the contract at index contract_id.")
+        .def_readwrite("contract_id", &Leg::contract_id, "Index into the contract table.")
+        .def_readwrite("quantity", &Leg::quantity, "Signed size; negative for short legs.");
+
+    py::class_<Strategy>(m, "Strategy")
+        .def(py::init([](std::vector<Leg> legs) { return Strategy{std::move(legs)}; }),
+             py::arg("legs"),
+             "A multi-leg strategy built from legs that reference shared contracts.")
+        .def_readwrite("legs", &Strategy::legs, "List of Leg objects.");
+
+    py::class_<StrategyValue>(m, "StrategyValue")
+        .def_readonly("price", &StrategyValue::price, "Signed sum of leg prices.")
+        .def_readonly("greeks", &StrategyValue::greeks, "Signed sum of leg Greeks.");
+
+    py::class_<StrategyBatchResult>(m, "StrategyBatchResult")
+        .def_readonly("values", &StrategyBatchResult::values,
+                      "One StrategyValue per strategy, in input order.")
+        .def_readonly("total_legs", &StrategyBatchResult::total_legs,
+                      "Legs across all strategies.")
+        .def_readonly("unique_legs", &StrategyBatchResult::unique_legs,
+                      "Distinct contracts actually priced.");
+
+    m.def("price_strategies",
+          [](const BoundBatch& batch, const std::vector<Strategy>& strategies) {
+              const ReadLock lock(batch.mutex);
+              return price_strategies(batch_rows(batch), strategies);
+          },
+          py::call_guard<py::gil_scoped_release>(), py::arg("batch"), py::arg("strategies"),
+          "Price strategies whose legs index into the rows of a ContractBatch.");
+
+    m.def("price_strategies",
+          py::overload_cast<const std::vector<Contract>&, const std::vector<Strategy>&>(
+              &price_strategies),
+          py::call_guard<py::gil_scoped_release>(),
+          py::arg("contracts"), py::arg("strategies"),
+          "Price strategies whose legs index into contracts, pricing each shared leg once.");
+
+    // --- Hash-based batch deduplication ---
+    py::class_<DedupStats>(m, "DedupStats")
+        .def_readonly("total", &DedupStats::total, "Contracts in the input batch.")
+        .def_readonly("unique", &DedupStats::unique, "Distinct contracts actually priced.")
+        .def_property_readonly("ratio", &DedupStats::ratio, "total / unique.");
+
+    m.def("price_batch_dedup",
+          [](const BoundBatch& batch) {
+              const ReadLock lock = lock_batch<ReadLock>(batch);
+              static thread_local DedupArena arena;
+              py::array_t<double> prices(static_cast<py::ssize_t>(batch.size()));
+              double* out = prices.mutable_data();
+              DedupStats stats{};
+              {
+                  py::gil_scoped_release release;
+                  price_batch_dedup(batch_rows(batch), Span<double>(out, batch.size()), arena,
+                                    &stats);
+              }
+              return py::make_tuple(prices, stats);
+          },
+          py::arg("batch"),
+          "Price a ContractBatch, evaluating identical rows once. "
+          "Returns (NumPy prices, DedupStats).");
+
+    m.def("price_batch_dedup",
+          [](const std::vector<Contract>& contracts) {
+              static thread_local DedupArena arena; // reused across calls on this thread
+              DedupStats stats{};
+              std::vector<double> prices;
+              {
+                  py::gil_scoped_release release;
+                  prices = price_batch_dedup(contracts, arena, &stats);
+              }
+              return py::make_tuple(std::move(prices), stats);
+          },
+          py::arg("contracts"),
+          "Price a list of Contract objects, evaluating identical contracts once. "
+          "Returns (prices, DedupStats).");
+
+    // --- Quantized-input result cache ---
+    py::class_<CacheTolerances>(m, "CacheTolerances")
+        .def(py::init<>())
+        .def_readwrite("S", &CacheTolerances::S, "Spot tick.")
+        .def_readwrite("K", &CacheTolerances::K, "Strike tick.")
+        .def_readwrite("r", &CacheTolerances::r, "Rate tick.")
+        .def_readwrite("sigma", &CacheTolerances::sigma, "Vol tick.")
+        .def_readwrite("T", &CacheTolerances::T, "Time-to-expiry tick in years.");
+
+    py::class_<CacheConfig>(m, "CacheConfig")
+        .def(py::init<>())
+        .def_readwrite("capacity", &CacheConfig::capacity, "Maximum number of entries.")
+        .def_readwrite("tolerances", &CacheConfig::tolerances, "Quantization step per input.");
+
+    py::class_<CacheStats>(m, "CacheStats")
+        .def_readonly("hits", &CacheStats::hits)
+        .def_readonly("misses", &CacheStats::misses)
+        .def_readonly("evictions", &CacheStats::evictions)
+        .def("__repr__", [](const CacheStats& s) {
+            std::ostringstream ss;
+            ss << "CacheStats(hits=" << s.hits << ", misses=" << s.misses
+               << ", evictions=" << s.evictions << ")";
+            return ss.str();
+        });
+
+    py::class_<PricingCache>(m, "PricingCache")
+        .def(py::init<const CacheConfig&>(), py::arg("config") = CacheConfig{},
+             "Bounded memoization cache keyed on quantized inputs.")
+        .def("price", &PricingCache::price,
+             py::arg("S"), py::arg("K"), py::arg("r"), py::arg("sigma"),
+             py::arg("T"), py::arg("option_type"),
+             "price_option, served from the cache when the quantized inputs match.")
+        .def("greeks", &PricingCache::greeks,
+             py::arg("S"), py::arg("K"), py::arg("r"), py::arg("sigma"),
+             py::arg("T"), py::arg("option_type"),
+             "compute_greeks, served from the cache when the quantized inputs match.")
+        .def("stats", &PricingCache::stats, "Hit, miss and eviction counters.")
+        .def("clear", &PricingCache::clear, "Drop all entries and reset counters.")
+        .def_property_readonly("capacity", &PricingCache::capacity);
+
+    // --- Lazy dependency-graph repricing ---
+    py::enum_<InputKind>(m, "InputKind")
+        .value("SPOT", InputKind::SPOT)
+        .value("RATE", InputKind::RATE)
+        .value("VOL", InputKind::VOL);
+
+    py::class_<GraphStats>(m, "GraphStats")
+        .def_readonly("last_recomputed", &GraphStats::last_recomputed)
+        .def_readonly("total_recomputed", &GraphStats::total_recomputed)
+        .def_readonly("flushes", &GraphStats::flushes)
+        .def_readonly("last_recompute_ns", &GraphStats::last_recompute_ns)
+        .def_readonly("total_recompute_ns", &GraphStats::total_recompute_ns);
+
+    py::class_<Locked<PricingGraph>>(m, "PricingGraph")
+        .def(py::init<>())
+        .def("add_input", locked(&PricingGraph::add_input), py::arg("kind"), py::arg("value"),
+             "Add a market input node; returns its id.")
+        .def("add_contract", locked(&PricingGraph::add_contract),
+             py::arg("spot"), py::arg("rate"), py::arg("vol"), py::arg("K"), py::arg("T"),
+             py::arg("option_type"),
+             "Add a contract reading the given spot/rate/vol nodes; returns its id.")
+        .def("set_input", locked(&PricingGraph::set_input), py::arg("node"), py::arg("value"),
+             "Update a market input and mark its dependents dirty.")
+        .def("input", locked(&PricingGraph::input), py::arg("node"))
+        .def("price", locked(&PricingGraph::price), py::arg("contract"),
+             "Price of one contract, re-evaluating dirty contracts first.")
+        .def("prices", locked(&PricingGraph::prices),
+             "All prices in insertion order, re-evaluating dirty contracts first.")
+        .def_property_readonly("dirty_count", locked(&PricingGraph::dirty_count))
+        .def_property_readonly("stats", locked(&PricingGraph::stats))
+        .def("__len__", locked(&PricingGraph::size));
+
+    // --- Incremental per-underlying risk ---
+    py::class_<Valuation>(m, "Valuation")
+        .def_readonly("price", &Valuation::price)
+        .def_readonly("greeks", &Valuation::greeks);
+
+    py::class_<Locked<RiskAggregator>>(m, "RiskAggregator")
+        .def(py::init<std::size_t>(), py::arg("resum_interval") = 1024,
+             "Per-underlying price/Greeks totals maintained incrementally.")
+        .def("add_underlying", locked(&RiskAggregator::add_underlying), py::arg("spot"))
+        .def("add_trade", locked(&RiskAggregator::add_trade),
+             py::arg("underlying"), py::arg("quantity"), py::arg("K"), py::arg("r"),
+             py::arg("sigma"), py::arg("T"), py::arg("option_type"),
+             "Book a trade; returns its id. O(1).")
+        .def("remove_trade", locked(&RiskAggregator::remove_trade), py::arg("trade"),
+             "Remove a booked trade. O(1).")
+        .def("move_spot", locked(&RiskAggregator::move_spot), py::arg("underlying"),
+             py::arg("spot"),
+             "Move a spot and re-value the trades on that underlying.")
+        .def("totals", locked(&RiskAggregator::totals), py::arg("underlying"))
+        .def("spot", locked(&RiskAggregator::spot), py::arg("underlying"))
+        .def("trade_count", locked(&RiskAggregator::trade_count), py::arg("underlying"))
+        .def("resum_all", locked(&RiskAggregator::resum_all),
+             "Re-sum all totals from per-trade contributions.");
+
+    // --- Incremental end-of-day risk ---
+    py::class_<IncrementalRunResult>(m, "IncrementalRunResult")
+        .def_readonly("prices", &IncrementalRunResult::prices, "One price per input row.")
+        .def_readonly("recomputed", &IncrementalRunResult::recomputed,
+                      "Rows that were actually repriced.")
+        .def_property_readonly("fraction_recomputed", &IncrementalRunResult::fraction_recomputed);
+
+    m.def("run_eod",
+          [](const BoundBatch& batch, const std::string& snapshot_path) {
+              const ReadLock lock(batch.mutex);
+              return run_eod(batch, snapshot_path);
+          },
+          py::call_guard<py::gil_scoped_release>(), py::arg("batch"), py::arg("snapshot_path"),
+          "ContractBatch form of run_eod.");
+
+    m.def("run_eod",
+          [](const std::vector<Contract>& contracts, const std::string& snapshot_path) {
+              return run_eod(to_batch(contracts), snapshot_path);
+          },
+          py::call_guard<py::gil_scoped_release>(), py::arg("contracts"), py::arg("snapshot_path"),
+          "Reprice only rows that changed since the snapshot at snapshot_path, then "
+          "overwrite the snapshot with today's inputs and prices.");
+
+    // --- NumPy ufuncs: op.price / op.greeks broadcast over arrays ---
+#ifdef OPTIONS_PRICER_UFUNCS
+    register_ufuncs(m);
+#endif
+
+    // --- Parameter grids (NumPy in, NumPy out) ---
+    m.def("price_grid",
+          [](const Contract& base, std::optional<DoubleArray> S, std::optional<DoubleArray> K,
+             std::optional<DoubleArray> r, std::optional<DoubleArray> sigma,
+             std::optional<DoubleArray> T) {
+              GridAxes axes;
+              std::vector<py::ssize_t> dims;
+              take_axis(S, "S", axes.S, dims);
+              take_axis(K, "K", axes.K, dims);
+              take_axis(r, "r", axes.r, dims);
+              take_axis(sigma, "sigma", axes.sigma, dims);
+              take_axis(T, "T", axes.T, dims);
+
+              py::array_t<double> out(dims);
+              double* data = out.mutable_data();
+              {
+                  py::gil_scoped_release release;
+                  static thread_local PricingWorkspace ws; // reused across calls on this thread
+                  price_grid(base, axes, Span<double>(data, axes.size()), ws, &grid_pool());
+              }
+              return out;
+          },
+          py::arg("contract"), py::kw_only(), py::arg("S") = py::none(),
+          py::arg("K") = py::none(), py::arg("r") = py::none(), py::arg("sigma") = py::none(),
+          py::arg("T") = py::none(),
+          "Price `contract` over the Cartesian product of the given axes. Returns an array "
+          "with one dimension per axis passed, in the order S, K, r, sigma, T.");
+
+    m.def("greeks_grid",
+          [](const Contract& base, std::optional<DoubleArray> S, std::optional<DoubleArray> K,
+             std::optional<DoubleArray> r, std::optional<DoubleArray> sigma,
+             std::optional<DoubleArray> T) {
+              GridAxes axes;
+              std::vector<py::ssize_t> dims;
+              take_axis(S, "S", axes.S, dims);
+              take_axis(K, "K", axes.K, dims);
+              take_axis(r, "r", axes.r, dims);
+              take_axis(sigma, "sigma", axes.sigma, dims);
+              take_axis(T, "T", axes.T, dims);
+
+              std::vector<py::ssize_t> record_dims = dims;
+              record_dims.push_back(5);
+              py::array_t<double> out(record_dims);
+              auto* data = reinterpret_cast<Valuation*>(out.mutable_data());
+              {
+                  py::gil_scoped_release release;
+                  static thread_local PricingWorkspace ws;
+                  greeks_grid(base, axes, Span<Valuation>(data, axes.size()), ws, &grid_pool());
+              }
+
+              py::dict result;
+              const char* names[] = {"price", "delta", "gamma", "vega", "theta"};
+              for (py::ssize_t k = 0; k < 5; ++k) {
+                  result[names[k]] = py::object(out[py::make_tuple(py::ellipsis(), k)]);
+              }
+              return result;
+          },
+          py::arg("contract"), py::kw_only(), py::arg("S") = py::none(),
+          py::arg("K") = py::none(), py::arg("r") = py::none(), py::arg("sigma") = py::none(),
+          py::arg("T") = py::none(),
+          "Price and Greeks of `contract` over the Cartesian product of the given axes. "
+          "Returns a dict of arrays (price, delta, gamma, vega, theta), each shaped like "
+          "price_grid's result. Greeks follow compute_greeks' units.");
+
+    // --- Implied volatility and chain-to-surface ---
+    m.def("implied_vol", &implied_vol, py::arg("price"), py::arg("S"), py::arg("K"),
+          py::arg("r"), py::arg("T"), py::arg("option_type"), py::arg("tol") = 1e-6,
+          py::arg("max_iter") = 100,
+          "Implied volatility (decimal) from a price: safeguarded Newton-Raphson on vega. "
+          "Returns NaN when no volatility in [1e-6, 10] reproduces the price.");
+
+    m.def("iv_surface",
+          [](double spot, const py::sequence& chains, double max_spread_ratio,
+             double strike_band, double r) {
+              std::vector<DoubleArray> keep;
+              keep.reserve(6 * chains.size()); // spans point into these; no reallocation
+              std::vector<ExpiryChain> native;
+              for (const auto& chain : chains) {
+                  const auto fields = chain.cast<py::sequence>();
+                  if (fields.size() != 3) {
+                      throw py::value_error("iv_surface: each expiry must be (T, calls, puts)");
+                  }
+                  native.push_back(ExpiryChain{fields[0].cast<double>(),
+                                               take_side(fields[1], keep),
+                                               take_side(fields[2], keep)});
+              }
+              const SurfaceOptions options{max_spread_ratio, strike_band, r};
+
+              IvSurface surface;
+              {
+                  py::gil_scoped_release release;
+                  surface = build_iv_surface(native, spot, options, &grid_pool());
+              }
+
+              return surface_dict(surface);
+          },
+          py::arg("spot"), py::arg("chains"), py::kw_only(), py::arg("max_spread_ratio") = 0.50,
+          py::arg("strike_band") = 0.20, py::arg("r") = 0.05,
+          "Implied-vol surface from raw chains in one call. `chains` is a sequence of "
+          "(T, (call_strikes, call_bids, call_asks), (put_strikes, put_bids, put_asks)). "
+          "Quotes are filtered (positive bid/ask, spread, strike band), solved on the mid, "
+          "merged (puts at or below spot, calls above, gaps from either side), and the "
+          "strikes common to every liquid expiry kept. Expiries are solved in parallel. "
+          "Returns a dict: strikes, T (ascending), expiry (input index per row), quoted "
+          "(liquid strikes per input expiry) and iv, a (len(T), len(strikes)) decimal grid.");
+
+    // --- Rate and dividend-yield curves ---
+    // Lookups take any array shape (or a scalar) and return the same shape.
+    const auto curve_lookup = [](void (YieldCurve::*lookup)(Span<const double>, Span<double>)
+                                     const) {
+        return [lookup](const YieldCurve& curve, const DoubleArray& T) {
+            py::array_t<double> out(std::vector<py::ssize_t>(T.shape(), T.shape() + T.ndim()));
+            const auto n = static_cast<std::size_t>(T.size());
+            (curve.*lookup)(Span<const double>(T.data(), n), Span<double>(out.mutable_data(), n));
+            return out;
+        };
+    };
+    py::class_<YieldCurve>(m, "YieldCurve")
+        .def(py::init<const std::vector<double>&, const std::vector<double>&>(),
+             py::arg("times"), py::arg("zero_rates"),
+             "Continuously compounded curve from zero rates at strictly increasing pillar "
+             "times, interpolated log-linearly in discount factors. Also used for dividend "
+             "yields.")
+        .def_static("from_discount_factors", &YieldCurve::from_discount_factors,
+                    py::arg("times"), py::arg("discount_factors"))
+        .def_static("flat", &YieldCurve::flat, py::arg("rate"))
+        .def("discount",
+             curve_lookup(py::overload_cast<Span<const double>, Span<double>>(
+                 &YieldCurve::discount, py::const_)),
+             py::arg("T"), "Discount factors at T (array or scalar).")
+        .def("zero_rate",
+             curve_lookup(py::overload_cast<Span<const double>, Span<double>>(
+                 &YieldCurve::zero_rate, py::const_)),
+             py::arg("T"), "Zero rates at T (array or scalar).")
+        .def_property_readonly("times", [](const YieldCurve& c) {
+            const Span<const double> t = c.times();
+            return py::array_t<double>(static_cast<py::ssize_t>(t.size()), t.data());
+        });
+
+    m.def("price_batch_curves",
+          [](const BoundBatch& batch, const YieldCurve& rates, const YieldCurve& dividends) {
+              const ReadLock lock = lock_batch<ReadLock>(batch);
+              py::array_t<double> prices(static_cast<py::ssize_t>(batch.size()));
+              double* out = prices.mutable_data();
+              {
+                  py::gil_scoped_release release;
+                  price_batch_curves(batch, rates, dividends, Span<double>(out, batch.size()));
+              }
+              return prices;
+          },
+          py::arg("batch"), py::arg("rates"), py::arg("dividends") = YieldCurve::flat(0.0),
+          "Price a ContractBatch with r and the dividend yield read off curves at each row's "
+          "T (the batch's r column is ignored).");
+
+    m.def("price_batch_escrowed",
+          [](const BoundBatch& batch,
+             const py::array_t<std::uint32_t, py::array::c_style | py::array::forcecast>&
+                 underlying,
+             const std::vector<std::pair<std::vector<double>, std::vector<double>>>& schedules,
+             const YieldCurve& discount) {
+              const ReadLock lock = lock_batch<ReadLock>(batch);
+              std::vector<DividendSchedule> native;
+              native.reserve(schedules.size());
+              for (const auto& s : schedules) {
+                  native.push_back({s.first, s.second});
+              }
+              py::array_t<double> prices(static_cast<py::ssize_t>(batch.size()));
+              double* out = prices.mutable_data();
+              {
+                  py::gil_scoped_release release;
+                  static thread_local PricingWorkspace ws;
+                  const EscrowedDividends dividends(native, discount);
+                  price_batch_escrowed(
+                      batch,
+                      Span<const std::uint32_t>(underlying.data(),
+                                                static_cast<std::size_t>(underlying.size())),
+                      dividends, Span<double>(out, batch.size()), ws);
+              }
+              return prices;
+          },
+          py::arg("batch"), py::arg("underlying"), py::arg("schedules"), py::arg("discount"),
+          "European prices with discrete cash dividends (escrowed model). `schedules` is a "
+          "list of (ex_times, amounts) per underlying; row i uses schedules[underlying[i]]. "
+          "Dividends are discounted on `discount` (YieldCurve.flat(r) for a flat rate).");
+
+    // --- Warm-state snapshot for fast restarts ---
+    m.def("save_warm_state",
+          [](const std::string& path, const BoundBatch& batch,
+             std::optional<DoubleArray> prices, const py::dict& surfaces,
+             const PricingCache* cache) {
+              const ReadLock lock = lock_batch<ReadLock>(batch);
+              WarmState state;
+              state.contracts = batch;
+              if (prices) {
+                  state.prices = Span<const double>(prices->data(),
+                                                    static_cast<std::size_t>(prices->size()));
+              }
+              std::vector<NamedSurface> named;
+              for (const auto& item : surfaces) {
+                  named.push_back({item.first.cast<std::string>(),
+                                   surface_from_dict(item.second.cast<py::dict>())});
+              }
+              state.surfaces = named;
+              state.cache    = cache;
+              py::gil_scoped_release release;
+              save_warm_state(path, state);
+          },
+          py::arg("path"), py::arg("batch"), py::kw_only(), py::arg("prices") = py::none(),
+          py::arg("surfaces") = py::dict(), py::arg("cache") = nullptr,
+          "Persist a warmed book (contracts, optional prices), named IV surfaces (dicts as "
+          "returned by iv_surface) and a PricingCache's entries to one memory-mappable "
+          "file, replaced atomically.");
+
+    py::class_<WarmStateFile>(m, "WarmStateFile")
+        .def(py::init<const std::string&>(), py::arg("path"),
+             "Map a file written by save_warm_state (read-only, no parsing of the book).")
+        .def("__len__", &WarmStateFile::size)
+        .def("contracts",
+             [](const WarmStateFile& f) {
+                 const BatchView v = f.contracts();
+                 auto batch = std::make_unique<BoundBatch>();
+                 batch->S.assign(v.S.begin(), v.S.end());
+                 batch->K.assign(v.K.begin(), v.K.end());
+                 batch->r.assign(v.r.begin(), v.r.end());
+                 batch->sigma.assign(v.sigma.begin(), v.sigma.end());
+                 batch->T.assign(v.T.begin(), v.T.end());
+                 batch->option_type.assign(v.option_type.begin(), v.option_type.end());
+                 return batch;
+             },
+             "The saved book as a ContractBatch (column copies).")
+        .def("price_batch",
+             [](const WarmStateFile& f) {
+                 py::array_t<double> out(static_cast<py::ssize_t>(f.size()));
+                 double* p = out.mutable_data();
+                 {
+                     py::gil_scoped_release release;
+                     price_batch(f.contracts(), Span<double>(p, f.size()));
+                 }
+                 return out;
+             },
+             "Price the saved book straight from the mapping.")
+        .def_property_readonly(
+            "prices",
+            [](const WarmStateFile& f) -> py::object {
+                if (f.prices().empty()) {
+                    return py::none();
+                }
+                return py::array_t<double>(static_cast<py::ssize_t>(f.size()),
+                                           f.prices().data());
+            },
+            "Saved prices (a copy), or None.")
+        .def_property_readonly(
+            "surfaces",
+            [](const WarmStateFile& f) {
+                py::dict result;
+                for (std::size_t i = 0; i < f.surface_count(); ++i) {
+                    result[py::str(f.surface_name(i))] = surface_dict(f.surface(i));
+                }
+                return result;
+            },
+            "Saved surfaces by name, in the iv_surface dict layout.")
+        .def_property_readonly("cache_entries", &WarmStateFile::cache_entries)
+        .def("warm", &WarmStateFile::warm, py::arg("cache"),
+             "Refill a PricingCache with the saved entries; returns how many were stored. "
+             "Raises ValueError if its tolerances differ from the saved cache's.");
+
+    // --- Time-decay projection ladder ---
+    m.def("project_time_decay",
+          [](const BoundBatch& batch, const std::vector<double>& horizon_days) {
+              const ReadLock lock = lock_batch<ReadLock>(batch);
+              py::array_t<double> values({static_cast<py::ssize_t>(batch.size()),
+                                          static_cast<py::ssize_t>(horizon_days.size())});
+              double* out = values.mutable_data();
+              {
+                  py::gil_scoped_release release;
+                  project_time_decay(batch, horizon_days,
+                                     Span<double>(out, batch.size() * horizon_days.size()));
+              }
+              return values;
+          },
+          py::arg("batch"), py::arg("horizon_days"),
+          "ContractBatch form: returns a (contracts, horizons) NumPy array.");
+
+    m.def("project_time_decay",
+          [](const std::vector<Contract>& contracts, const std::vector<double>& horizon_days) {
+              DecayLadder ladder;
+              {
+                  py::gil_scoped_release release;
+                  ladder = project_time_decay(to_batch(contracts), horizon_days);
+              }
+              std::vector<std::vector<double>> rows(ladder.contracts);
+              for (std::size_t i = 0; i < ladder.contracts; ++i) {
+                  const double* row = ladder.values.data() + i * ladder.horizons;
+                  rows[i].assign(row, row + ladder.horizons);
+              }
+              return rows;
+          },
+          py::arg("contracts"), py::arg("horizon_days"),
+          "Value of each contract at each horizon (calendar days ahead), spot and vol held "
+          "fixed. Returns one row per contract.");
+
+    m.def("project_book_decay",
+          [](const BoundBatch& batch, const std::vector<double>& quantities,
+             const std::vector<double>& horizon_days) {
+              const ReadLock lock = lock_batch<ReadLock>(batch);
+              py::array_t<double> totals(static_cast<py::ssize_t>(horizon_days.size()));
+              double* out = totals.mutable_data();
+              {
+                  py::gil_scoped_release release;
+                  project_book_decay(batch, quantities, horizon_days,
+                                     Span<double>(out, horizon_days.size()));
+              }
+              return totals;
+          },
+          py::arg("batch"), py::arg("quantities"), py::arg("horizon_days"),
+          "ContractBatch form: returns a NumPy array of book values per horizon.");
+
+    m.def("project_book_decay",
+          [](const std::vector<Contract>& contracts, const std::vector<double>& quantities,
+             const std::vector<double>& horizon_days) {
+              return project_book_decay(to_batch(contracts), quantities, horizon_days);
+          },
+          py::call_guard<py::gil_scoped_release>(), py::arg("contracts"), py::arg("quantities"),
+          py::arg("horizon_days"),
+          "Quantity-weighted book value at each horizon (calendar days ahead).");
 }
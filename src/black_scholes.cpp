@@ -1,18 +1,12 @@
 #include "black_scholes.hpp"
 
+#include "bs_kernel.hpp"
+
 #include <cmath>
+#include <limits>
 
 namespace {
 
-/// Standard normal CDF via the complementary error function: N(x) = erfc(-x/√2) / 2.
-inline double norm_cdf(double x) { return std::erfc(-x / std::sqrt(2.0)) / 2.0; }
-
-/// Standard normal PDF.
-inline double norm_pdf(double x) {
-    constexpr double INV_SQRT_2PI = 0.3989422804014327; // 1 / sqrt(2π)
-    return INV_SQRT_2PI * std::exp(-0.5 * x * x);
-}
-
 /// d1: log-moneyness adjusted for risk-free drift and half-variance; drives delta.
 inline double d1(double S, double K, double r, double sigma, double T) {
     return (std::log(S / K) + (r + 0.5 * sigma * sigma) * T) / (sigma * std::sqrt(T));
@@ -37,6 +31,12 @@ double price_option(double S, double K, double r, double sigma, double T, Option
     }
 }
 
+double price_option_guarded(double S, double K, double r, double sigma, double T,
+                            OptionType type) {
+    const double log_m = S > 0.0 && K > 0.0 ? std::log(S / K) : 0.0;
+    return guarded_value(S, K, log_m, r, r + 0.5 * sigma * sigma, sigma, T, payoff_sign(type));
+}
+
 Greeks compute_greeks(double S, double K, double r, double sigma, double T, OptionType type) {
     const double d1v   = d1(S, K, r, sigma, T);
     const double d2v   = d2(d1v, sigma, T);
@@ -69,3 +69,69 @@ Greeks compute_greeks(double S, double K, double r, double sigma, double T, Opti
 
     return g;
 }
+
+PreparedContract prepare_contract(double K, double r, double sigma, double T, OptionType type) {
+    PreparedContract p{};
+    p.K           = K;
+    p.r           = r;
+    p.sigma       = sigma;
+    p.T           = T;
+    p.type        = type;
+    p.log_K       = std::log(K);
+    p.drift       = (r + 0.5 * sigma * sigma) * T;
+    p.sqrtT       = std::sqrt(T);
+    p.sigma_sqrtT = sigma * p.sqrtT;
+    p.disc_K      = K * std::exp(-r * T);
+    return p;
+}
+
+Valuation value_prepared(const PreparedContract& p, double S) {
+    return prepared_valuation(p, S, std::log(S));
+}
+
+double implied_vol(double price, double S, double K, double r, double T, OptionType type,
+                   double tol, int max_iter) {
+    constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+    if (!(S > 0.0 && K > 0.0 && T > 0.0) || !std::isfinite(price)) {
+        return NaN;
+    }
+
+    const double log_m  = std::log(S / K);
+    const double sqrtT  = std::sqrt(T);
+    const double disc_K = K * std::exp(-r * T);
+    const double w      = payoff_sign(type);
+
+    // Price error and dPrice/dsigma at sigma, sharing d1.
+    const auto error = [&](double sigma, double* vega) {
+        const double sst = sigma * sqrtT;
+        const double d1v = (log_m + (r + 0.5 * sigma * sigma) * T) / sst;
+        if (vega != nullptr) {
+            *vega = S * norm_pdf(d1v) * sqrtT;
+        }
+        return w * (S * norm_cdf(w * d1v) - disc_K * norm_cdf(w * (d1v - sst))) - price;
+    };
+
+    double lo = IV_MIN;
+    double hi = IV_MAX;
+    if (error(lo, nullptr) > tol || error(hi, nullptr) < -tol) {
+        return NaN; // below the near-zero-vol price or above the IV_MAX price
+    }
+
+    double sigma = 0.2;
+    for (int i = 0; i < max_iter; ++i) {
+        double vega    = 0.0;
+        const double f = error(sigma, &vega);
+        if (std::fabs(f) <= tol) {
+            return sigma;
+        }
+        // Price increases with sigma, so the sign of f says which side the root is on.
+        if (f > 0.0) {
+            hi = sigma;
+        } else {
+            lo = sigma;
+        }
+        const double step = sigma - f / vega;
+        sigma             = step > lo && step < hi ? step : 0.5 * (lo + hi);
+    }
+    return NaN;
+}
@@ -20,6 +20,62 @@ struct Greeks {
 /// @param type  CALL or PUT
 double price_option(double S, double K, double r, double sigma, double T, OptionType type);
 
+/// |d1|, |d2| bound used by price_option_guarded. N(-37) ~ 6e-300 is still a normal
+/// double and 1 - N(37) rounds to exactly 1, so clamping changes no representable price
+/// while keeping erfc and exp(-d²/2) out of the subnormal range.
+constexpr double D_CLAMP = 37.0;
+
+/// Black-Scholes price that stays finite for degenerate inputs, without branching.
+/// Rows with T <= 0, sigma <= 0, S <= 0 or K <= 0 get the discounted intrinsic value
+/// max(±(S - K·e^(-r·max(T,0))), 0) through a select; d1/d2 are clamped to ±D_CLAMP and
+/// the result is floored at that intrinsic value. A NaN in any input returns NaN, so
+/// missing market data is flagged rather than priced. Matches price_option to rounding
+/// error on well-formed rows.
+double price_option_guarded(double S, double K, double r, double sigma, double T,
+                            OptionType type);
+
 /// Analytical Black-Scholes Greeks for a European option.
 /// Same parameter conventions as price_option.
 Greeks compute_greeks(double S, double K, double r, double sigma, double T, OptionType type);
+
+/// Volatility bracket searched by implied_vol.
+constexpr double IV_MIN = 1e-6;
+constexpr double IV_MAX = 10.0;
+
+/// Implied volatility of a European option from its price.
+/// Newton steps on vega from sigma = 0.2, kept inside a shrinking [IV_MIN, IV_MAX] bracket:
+/// a step that would leave the bracket bisects it instead, so deep OTM quotes with
+/// near-zero vega still converge. ln(S/K), √T and K·e^(-rT) are taken once per solve.
+/// Returns NaN if S, K or T is not positive, the price lies outside the prices reachable
+/// within the bracket, or |price error| <= tol is not reached in max_iter iterations.
+double implied_vol(double price, double S, double K, double r, double T, OptionType type,
+                   double tol = 1e-6, int max_iter = 100);
+
+/// Price and Greeks of one contract, evaluated together.
+struct Valuation {
+    double price;
+    Greeks greeks;
+};
+
+/// Spot-independent terms of a contract, computed once so that repricing after a spot
+/// move only needs log(S) plus the CDF/PDF evaluations.
+struct PreparedContract {
+    double K;
+    double r;
+    double sigma;
+    double T;
+    OptionType type;
+    double log_K;       ///< ln(K)
+    double drift;       ///< (r + σ²/2)·T
+    double sqrtT;       ///< √T
+    double sigma_sqrtT; ///< σ·√T
+    double disc_K;      ///< K·e^(-rT)
+};
+
+/// Precompute the spot-independent terms of a contract.
+PreparedContract prepare_contract(double K, double r, double sigma, double T, OptionType type);
+
+/// Price and Greeks of a prepared contract at spot S.
+/// Sweeps that already have ln(S) can use prepared_valuation (bs_kernel.hpp) instead.
+/// Matches price_option / compute_greeks to rounding error.
+Valuation value_prepared(const PreparedContract& p, double S);
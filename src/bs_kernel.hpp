@@ -0,0 +1,101 @@
+#pragma once
+
+#include "black_scholes.hpp"
+
+#include <cmath>
+#include <limits>
+
+// ---------------------------------------------------------------------------
+// Inline building blocks shared by the Black-Scholes kernels (single contract,
+// time-decay ladder, parameter grids). Kept header-only so each kernel's inner
+// loop inlines them instead of calling across translation units.
+// ---------------------------------------------------------------------------
+
+/// Standard normal CDF via the complementary error function: N(x) = erfc(-x/√2) / 2.
+inline double norm_cdf(double x) { return std::erfc(-x / std::sqrt(2.0)) / 2.0; }
+
+/// Standard normal PDF.
+inline double norm_pdf(double x) {
+    constexpr double INV_SQRT_2PI = 0.3989422804014327; // 1 / sqrt(2π)
+    return INV_SQRT_2PI * std::exp(-0.5 * x * x);
+}
+
+/// Clamp to [lo, hi] with plain selects, which compile to minsd/maxsd; std::fmin/fmax
+/// must honour NaN operands and are often emitted as libm calls.
+inline double clamp_select(double x, double lo, double hi) {
+    x = x < lo ? lo : x;
+    return x > hi ? hi : x;
+}
+
+/// +1 for calls, -1 for puts, so that price = w·(S·N(w·d1) - K·disc·N(w·d2)).
+inline double payoff_sign(OptionType type) { return type == OptionType::CALL ? 1.0 : -1.0; }
+
+/// Price of a prepared contract at spot S with ln(S) supplied by the caller.
+/// Same arithmetic as price_option, with the type folded into a sign.
+inline double prepared_price(const PreparedContract& p, double S, double log_S) {
+    const double d1v = (log_S - p.log_K + p.drift) / p.sigma_sqrtT;
+    const double d2v = d1v - p.sigma_sqrtT;
+    const double w   = payoff_sign(p.type);
+    return w * (S * norm_cdf(w * d1v) - p.disc_K * norm_cdf(w * d2v));
+}
+
+/// Price and Greeks of a prepared contract at spot S, with ln(S) supplied by the caller
+/// so sweeps over many contracts at one spot take the logarithm once.
+inline Valuation prepared_valuation(const PreparedContract& p, double S, double log_S) {
+    const double d1v   = (log_S - p.log_K + p.drift) / p.sigma_sqrtT;
+    const double d2v   = d1v - p.sigma_sqrtT;
+    const double sqrtT = p.sqrtT;
+    const double npd1  = norm_pdf(d1v); // N'(d1): shared by gamma, vega and theta
+
+    Valuation v{};
+    v.greeks.gamma = npd1 / (S * p.sigma_sqrtT);
+    v.greeks.vega  = S * npd1 * sqrtT / 100.0;
+
+    const double common_term = -(S * npd1 * p.sigma) / (2.0 * sqrtT);
+    if (p.type == OptionType::CALL) {
+        const double nd1 = norm_cdf(d1v);
+        const double nd2 = norm_cdf(d2v);
+        v.price          = S * nd1 - p.disc_K * nd2;
+        v.greeks.delta   = nd1;
+        v.greeks.theta   = (common_term - p.r * p.disc_K * nd2) / 365.0;
+    } else {
+        const double nmd1 = norm_cdf(-d1v);
+        const double nmd2 = norm_cdf(-d2v);
+        v.price           = p.disc_K * nmd2 - S * nmd1;
+        v.greeks.delta    = -nmd1;
+        v.greeks.theta    = (common_term + p.r * p.disc_K * nmd2) / 365.0;
+    }
+    return v;
+}
+
+/// Guarded Black-Scholes value from hoisted terms (see price_option_guarded).
+/// @param log_m  ln(S/K); ignored when S or K is not positive
+/// @param mu     r + σ²/2
+/// @param tau    Remaining time in years; <= 0 means expired
+/// @param w      payoff_sign(type)
+inline double guarded_value(double S, double K, double log_m, double r, double mu,
+                            double sigma, double tau, double w) {
+    const double tau_pos = tau > 0.0 ? tau : 0.0;
+    const double disc_K  = K * std::exp(-r * tau_pos);
+    const double sd      = sigma * std::sqrt(tau_pos);
+
+    // Missing market data must stay visible: a NaN input prices to NaN rather than to an
+    // intrinsic value that looks real. Only finite degenerate rows take the fallback.
+    const bool missing   = std::isnan(S) || std::isnan(K) || std::isnan(r) ||
+                           std::isnan(sigma) || std::isnan(tau);
+    const bool valid     = sd > 1e-12 && S > 0.0 && K > 0.0;
+    const double safe_lm = valid ? log_m : 0.0; // keep the division finite
+    const double safe_sd = valid ? sd : 1.0;
+
+    const double d1v = clamp_select((safe_lm + mu * tau_pos) / safe_sd, -D_CLAMP, D_CLAMP);
+    const double d2v = clamp_select(d1v - safe_sd, -D_CLAMP, D_CLAMP);
+
+    const double model     = w * (S * norm_cdf(w * d1v) - disc_K * norm_cdf(w * d2v));
+    const double payoff    = w * (S - disc_K);
+    const double intrinsic = payoff > 0.0 ? payoff : 0.0;
+    // Intrinsic is also the no-arbitrage floor: once both d's clamp to the same bound
+    // the model term can round a hair below zero.
+    const double floored = model > intrinsic ? model : intrinsic;
+    const double value   = valid ? floored : intrinsic;
+    return missing ? std::numeric_limits<double>::quiet_NaN() : value;
+}
@@ -0,0 +1,142 @@
+#include "curves.hpp"
+
+#include "bs_kernel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+void check_lengths(std::size_t inputs, std::size_t outputs, const char* fn) {
+    if (inputs != outputs) {
+        throw std::invalid_argument(std::string(fn) + ": output span length " +
+                                    std::to_string(outputs) + " != input length " +
+                                    std::to_string(inputs));
+    }
+}
+
+} // namespace
+
+YieldCurve::YieldCurve(const std::vector<double>& times, const std::vector<double>& zero_rates) {
+    if (zero_rates.size() != times.size()) {
+        throw std::invalid_argument("YieldCurve: times and zero_rates differ in length");
+    }
+    std::vector<double> log_df(times.size());
+    for (std::size_t i = 0; i < times.size(); ++i) {
+        log_df[i] = -zero_rates[i] * times[i];
+    }
+    build(times, log_df);
+}
+
+YieldCurve YieldCurve::from_discount_factors(const std::vector<double>& times,
+                                             const std::vector<double>& discount_factors) {
+    if (discount_factors.size() != times.size()) {
+        throw std::invalid_argument("YieldCurve: times and discount_factors differ in length");
+    }
+    std::vector<double> log_df(times.size());
+    for (std::size_t i = 0; i < times.size(); ++i) {
+        if (!(discount_factors[i] > 0.0)) {
+            throw std::invalid_argument("YieldCurve: discount factors must be positive");
+        }
+        log_df[i] = std::log(discount_factors[i]);
+    }
+    YieldCurve curve;
+    curve.build(times, log_df);
+    return curve;
+}
+
+YieldCurve YieldCurve::flat(double rate) { return YieldCurve({1.0}, {rate}); }
+
+void YieldCurve::build(const std::vector<double>& times, const std::vector<double>& log_df) {
+    if (times.empty()) {
+        throw std::invalid_argument("YieldCurve: at least one pillar is required");
+    }
+    times_.assign(1, 0.0);
+    log_df_.assign(1, 0.0);
+    for (std::size_t i = 0; i < times.size(); ++i) {
+        if (!(times[i] > times_.back()) || !std::isfinite(times[i]) ||
+            !std::isfinite(log_df[i])) {
+            throw std::invalid_argument("YieldCurve: pillar times must be finite, positive "
+                                        "and strictly increasing, with finite rates");
+        }
+        times_.push_back(times[i]);
+        log_df_.push_back(log_df[i]);
+    }
+    forward_.resize(times_.size() - 1);
+    for (std::size_t i = 0; i < forward_.size(); ++i) {
+        forward_[i] = -(log_df_[i + 1] - log_df_[i]) / (times_[i + 1] - times_[i]);
+    }
+}
+
+std::size_t YieldCurve::segment(double T, std::size_t hint) const {
+    const std::size_t last = forward_.size() - 1;
+    if (hint <= last && times_[hint] <= T && (hint == last || T < times_[hint + 1])) {
+        return hint;
+    }
+    // First node after T, minus one; T past the last pillar stays on the last segment.
+    const auto it       = std::upper_bound(times_.begin() + 1, times_.end(), T);
+    const std::size_t i = static_cast<std::size_t>(it - times_.begin()) - 1;
+    return std::min(i, last);
+}
+
+double YieldCurve::log_discount(double T, std::size_t& hint) const {
+    if (!(T > 0.0)) {
+        return 0.0;
+    }
+    hint = segment(T, hint);
+    return log_df_[hint] - forward_[hint] * (T - times_[hint]);
+}
+
+double YieldCurve::discount(double T) const {
+    std::size_t hint = 0;
+    return std::exp(log_discount(T, hint));
+}
+
+double YieldCurve::zero_rate(double T) const {
+    std::size_t hint = 0;
+    return T > 0.0 ? -log_discount(T, hint) / T : forward_[0];
+}
+
+void YieldCurve::discount(Span<const double> T, Span<double> out) const {
+    check_lengths(T.size(), out.size(), "YieldCurve::discount");
+    std::size_t hint = 0;
+    for (std::size_t i = 0; i < T.size(); ++i) {
+        out[i] = std::exp(log_discount(T[i], hint));
+    }
+}
+
+void YieldCurve::zero_rate(Span<const double> T, Span<double> out) const {
+    check_lengths(T.size(), out.size(), "YieldCurve::zero_rate");
+    std::size_t hint = 0;
+    for (std::size_t i = 0; i < T.size(); ++i) {
+        const double t = T[i];
+        out[i]         = t > 0.0 ? -log_discount(t, hint) / t : forward_[0];
+    }
+}
+
+void price_batch_curves(const BatchView& batch, const YieldCurve& rates,
+                        const DividendCurve& dividends, Span<double> prices) {
+    const std::size_t n = batch.size();
+    check_lengths(n, prices.size(), "price_batch_curves");
+
+    std::size_t rate_hint = 0;
+    std::size_t div_hint  = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const double S     = batch.S[i];
+        const double K     = batch.K[i];
+        const double sigma = batch.sigma[i];
+        const double T     = batch.T[i];
+
+        const double log_D  = rates.log_discount(T, rate_hint);
+        const double log_Dq = dividends.log_discount(T, div_hint);
+        const double sd     = sigma * std::sqrt(T);
+        // ln(F/K) = ln(S/K) + ln Dq - ln D
+        const double d1v = (std::log(S / K) + log_Dq - log_D + 0.5 * sd * sd) / sd;
+        const double d2v = d1v - sd;
+        const double w   = payoff_sign(batch.option_type[i]);
+        prices[i] = w * (S * std::exp(log_Dq) * norm_cdf(w * d1v) -
+                         K * std::exp(log_D) * norm_cdf(w * d2v));
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "batch_pricer.hpp"
+#include "span.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/// Continuously compounded term structure with log-linear interpolation of discount
+/// factors: ln D(t) is linear between pillars, so the instantaneous forward rate is flat
+/// on each segment and D stays positive and monotone for positive rates. Before the first
+/// pillar the first zero rate holds from t = 0; past the last one the last segment's
+/// forward rate is extended.
+///
+/// The same object serves as the risk-free curve and as a dividend-yield curve
+/// (DividendCurve), whose "discount factor" e^(-q(T)·T) scales spot the way the
+/// risk-free one scales strike.
+class YieldCurve {
+  public:
+    /// Pillars at strictly increasing times > 0, with the zero rate at each.
+    /// Throws std::invalid_argument if the pillars are empty, unsorted, not positive,
+    /// not finite, or the lengths differ.
+    YieldCurve(const std::vector<double>& times, const std::vector<double>& zero_rates);
+
+    /// Same pillars given as discount factors (each > 0).
+    static YieldCurve from_discount_factors(const std::vector<double>& times,
+                                            const std::vector<double>& discount_factors);
+
+    /// One rate at every maturity.
+    static YieldCurve flat(double rate);
+
+    /// Discount factor D(T); 1 for T <= 0.
+    double discount(double T) const;
+
+    /// Zero rate -ln D(T) / T; the first pillar's rate for T <= 0.
+    double zero_rate(double T) const;
+
+    /// Batch lookups, out[i] for T[i]. The segment found for one row is tried first for
+    /// the next, so books grouped or sorted by expiry skip the binary search.
+    /// Never allocate; throw std::invalid_argument if the spans differ in length.
+    void discount(Span<const double> T, Span<double> out) const;
+    void zero_rate(Span<const double> T, Span<double> out) const;
+
+    /// Pillar times, without the implicit t = 0 node.
+    Span<const double> times() const { return Span<const double>(times_).subspan(1, pillars()); }
+
+    std::size_t pillars() const { return times_.size() - 1; }
+
+  private:
+    YieldCurve() = default;
+
+    void build(const std::vector<double>& times, const std::vector<double>& log_df);
+
+    /// Segment i with times_[i] <= T < times_[i + 1] (the last one for T past the last
+    /// pillar), trying `hint` first.
+    std::size_t segment(double T, std::size_t hint) const;
+
+    /// ln D(T), updating `hint` to the segment used.
+    double log_discount(double T, std::size_t& hint) const;
+
+    friend void price_batch_curves(const BatchView& batch, const YieldCurve& rates,
+                                   const YieldCurve& dividends, Span<double> prices);
+
+    std::vector<double> times_;   ///< 0, then the pillar times
+    std::vector<double> log_df_;  ///< ln D at each node (0 at t = 0)
+    std::vector<double> forward_; ///< Flat forward rate of segment i = [times_[i], times_[i+1]]
+};
+
+/// Continuous dividend-yield term structure; same interpolation as the rate curve.
+using DividendCurve = YieldCurve;
+
+/// Black-Scholes prices with the risk-free rate and dividend yield read off curves at
+/// each row's T; batch.r is ignored. Row i is priced on the forward
+/// F = S·Dq(T)/D(T) as D(T)·w·(F·N(w·d1) - K·N(w·d2)), which equals price_option with
+/// r = rates.zero_rate(T) and spot S·e^(-q(T)·T). Same conventions as price_option
+/// otherwise (T > 0, sigma > 0). Never allocates.
+/// Throws std::invalid_argument if prices.size() != batch.size().
+void price_batch_curves(const BatchView& batch, const YieldCurve& rates,
+                        const DividendCurve& dividends, Span<double> prices);
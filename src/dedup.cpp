@@ -0,0 +1,136 @@
+#include "dedup.hpp"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+/// Bit pattern of a double with -0.0 folded onto +0.0 so equal values hash equally.
+inline std::uint64_t canonical_bits(double x) {
+    if (x == 0.0) {
+        x = 0.0;
+    }
+    std::uint64_t bits;
+    std::memcpy(&bits, &x, sizeof bits);
+    return bits;
+}
+
+/// Final avalanche step from MurmurHash3 (fmix64).
+inline std::uint64_t mix(std::uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/// Independent multiplies per field (good ILP), then one avalanche to spread the sum.
+inline std::uint64_t hash_contract(const Contract& c) {
+    const std::uint64_t h = canonical_bits(c.S) * 0x9e3779b97f4a7c15ULL +
+                            canonical_bits(c.K) * 0xc2b2ae3d27d4eb4fULL +
+                            canonical_bits(c.r) * 0x165667b19e3779f9ULL +
+                            canonical_bits(c.sigma) * 0xd6e8feb86659fd93ULL +
+                            canonical_bits(c.T) * 0xff51afd7ed558ccdULL +
+                            static_cast<std::uint64_t>(c.option_type);
+    return mix(h);
+}
+
+inline bool same_contract(const Contract& a, const Contract& b) {
+    return canonical_bits(a.S) == canonical_bits(b.S) &&
+           canonical_bits(a.K) == canonical_bits(b.K) &&
+           canonical_bits(a.r) == canonical_bits(b.r) &&
+           canonical_bits(a.sigma) == canonical_bits(b.sigma) &&
+           canonical_bits(a.T) == canonical_bits(b.T) && a.option_type == b.option_type;
+}
+
+constexpr std::size_t INITIAL_CAPACITY = 1024;
+
+/// Table slots pack the upper 32 hash bits (a cheap reject tag) with unique index + 1.
+inline std::uint64_t pack_slot(std::uint64_t h, std::uint32_t u) {
+    return (h & 0xffffffff00000000ULL) | (static_cast<std::uint64_t>(u) + 1);
+}
+
+/// Double the table and reinsert every unique contract from its stored hash.
+void grow_table(DedupArena& arena) {
+    const std::size_t cap  = arena.table.size() * 2;
+    const std::size_t mask = cap - 1;
+    arena.table.assign(cap, 0);
+    for (std::size_t u = 0; u < arena.hashes.size(); ++u) {
+        std::size_t slot = arena.hashes[u] & mask;
+        while (arena.table[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        arena.table[slot] = pack_slot(arena.hashes[u], static_cast<std::uint32_t>(u));
+    }
+}
+
+} // namespace
+
+void price_batch_dedup(Span<const Contract> contracts, Span<double> prices, DedupArena& arena,
+                       DedupStats* stats) {
+    const std::size_t n = contracts.size();
+    if (prices.size() != n) {
+        throw std::invalid_argument("price_batch_dedup: output span length != batch size");
+    }
+    if (n >= std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error("price_batch_dedup: batch too large for 32-bit slot indices");
+    }
+
+    // The table is sized for the distinct contracts seen so far, not the batch, so
+    // heavily repeated batches probe a small cache-resident table.
+    arena.table.assign(INITIAL_CAPACITY, 0); // reuses existing capacity after the first call
+    arena.hashes.clear();
+    arena.unique.clear();
+    arena.index.resize(n);
+    std::size_t mask = INITIAL_CAPACITY - 1;
+
+    // Single pass: hash, probe, and record which unique slot each row maps to.
+    for (std::size_t i = 0; i < n; ++i) {
+        const Contract& c       = contracts[i];
+        const std::uint64_t h   = hash_contract(c);
+        const std::uint64_t tag = h & 0xffffffff00000000ULL;
+        std::size_t slot        = h & mask;
+
+        for (;;) {
+            const std::uint64_t entry = arena.table[slot];
+            if (entry == 0) {
+                const auto u = static_cast<std::uint32_t>(arena.unique.size());
+                arena.table[slot] = pack_slot(h, u);
+                arena.hashes.push_back(h);
+                arena.unique.push_back(c);
+                arena.index[i] = u;
+                if (2 * arena.unique.size() > arena.table.size()) { // keep load <= 50%
+                    grow_table(arena);
+                    mask = arena.table.size() - 1;
+                }
+                break;
+            }
+            const auto u = static_cast<std::uint32_t>(entry) - 1;
+            if ((entry & 0xffffffff00000000ULL) == tag && same_contract(arena.unique[u], c)) {
+                arena.index[i] = u;
+                break;
+            }
+            slot = (slot + 1) & mask; // linear probing
+        }
+    }
+
+    arena.unique_prices.resize(arena.unique.size());
+    price_batch(arena.unique, arena.unique_prices);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        prices[i] = arena.unique_prices[arena.index[i]];
+    }
+
+    if (stats != nullptr) {
+        *stats = DedupStats{n, arena.unique.size()};
+    }
+}
+
+std::vector<double> price_batch_dedup(const std::vector<Contract>& contracts, DedupArena& arena,
+                                      DedupStats* stats) {
+    std::vector<double> prices(contracts.size());
+    price_batch_dedup(contracts, prices, arena, stats);
+    return prices;
+}
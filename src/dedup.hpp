@@ -0,0 +1,42 @@
+#pragma once
+
+#include "batch_pricer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Reusable scratch space for price_batch_dedup.
+/// Keep one per thread and pass it to every call: the hash table and gather buffers
+/// grow to the largest batch seen and are then reused without reallocating.
+struct DedupArena {
+    std::vector<std::uint64_t> table;   ///< Open-addressing slots: hash tag | unique index + 1
+    std::vector<std::uint64_t> hashes;  ///< Full hash of each unique contract, for rehashing
+    std::vector<Contract> unique;       ///< Distinct contracts in first-seen order
+    std::vector<std::uint32_t> index;   ///< Input row -> position in `unique`
+    std::vector<double> unique_prices;  ///< Prices of `unique`
+};
+
+/// How much work the dedup stage saved on the last call.
+struct DedupStats {
+    std::size_t total;  ///< Contracts in the input batch
+    std::size_t unique; ///< Distinct contracts actually priced
+
+    /// total / unique; 1.0 means every contract was distinct.
+    double ratio() const { return unique == 0 ? 1.0 : static_cast<double>(total) / unique; }
+};
+
+/// Price a batch, evaluating each distinct (S, K, r, sigma, T, type) only once.
+/// Inputs are hashed in a single pass into an open-addressing table held in `arena`,
+/// the unique contracts go through price_batch, and prices are scattered back so the
+/// result matches price_batch(contracts) element for element.
+/// Pays off when the batch has many exact repeats; on all-distinct input it costs one
+/// extra hash/probe and gather per contract.
+/// Allocation-free once `arena` has seen a batch at least this large.
+/// Throws std::invalid_argument if prices.size() != contracts.size().
+void price_batch_dedup(Span<const Contract> contracts, Span<double> prices, DedupArena& arena,
+                       DedupStats* stats = nullptr);
+
+/// Allocating convenience form of price_batch_dedup.
+std::vector<double> price_batch_dedup(const std::vector<Contract>& contracts, DedupArena& arena,
+                                      DedupStats* stats = nullptr);
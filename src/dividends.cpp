@@ -0,0 +1,76 @@
+#include "dividends.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+EscrowedDividends::EscrowedDividends(Span<const DividendSchedule> schedules,
+                                     const YieldCurve& discount) {
+    offsets_.reserve(schedules.size() + 1);
+    offsets_.push_back(0);
+    std::vector<std::pair<double, double>> future; // (ex-time, amount) of one schedule
+    for (const DividendSchedule& s : schedules) {
+        if (s.amounts.size() != s.ex_times.size()) {
+            throw std::invalid_argument("EscrowedDividends: ex_times and amounts differ in "
+                                        "length");
+        }
+        future.clear();
+        for (std::size_t k = 0; k < s.ex_times.size(); ++k) {
+            if (!(s.amounts[k] >= 0.0) || !std::isfinite(s.amounts[k]) ||
+                !std::isfinite(s.ex_times[k])) {
+                throw std::invalid_argument("EscrowedDividends: dividend amounts must be "
+                                            "finite and non-negative, ex-times finite");
+            }
+            if (s.ex_times[k] > 0.0) {
+                future.emplace_back(s.ex_times[k], s.amounts[k]);
+            }
+        }
+        std::sort(future.begin(), future.end());
+
+        double pv = 0.0;
+        for (const auto& [t, amount] : future) {
+            pv += amount * discount.discount(t);
+            ex_times_.push_back(t);
+            cumulative_pv_.push_back(pv);
+        }
+        offsets_.push_back(ex_times_.size());
+    }
+}
+
+double EscrowedDividends::present_value(std::size_t underlying, double T) const {
+    const double* begin = ex_times_.data() + offsets_[underlying];
+    const double* end   = ex_times_.data() + offsets_[underlying + 1];
+    // Schedules are a handful of dates, so the search is a few compares.
+    const std::size_t paid = static_cast<std::size_t>(std::upper_bound(begin, end, T) - begin);
+    return paid == 0 ? 0.0 : cumulative_pv_[offsets_[underlying] + paid - 1];
+}
+
+void price_batch_escrowed(const BatchView& batch, Span<const std::uint32_t> underlying,
+                          const EscrowedDividends& dividends, Span<double> prices,
+                          PricingWorkspace& ws) {
+    const std::size_t n = batch.size();
+    if (underlying.size() != n || prices.size() != n) {
+        throw std::invalid_argument("price_batch_escrowed: underlying and prices must have "
+                                    "one entry per row (" + std::to_string(n) + ")");
+    }
+    const std::size_t count = dividends.underlyings();
+
+    ws.spots.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::uint32_t u = underlying[i];
+        if (u >= count) {
+            throw std::out_of_range("price_batch_escrowed: row " + std::to_string(i) +
+                                    " names underlying " + std::to_string(u) + " of " +
+                                    std::to_string(count));
+        }
+        const double S = batch.S[i] - dividends.present_value(u, batch.T[i]);
+        ws.spots[i]    = S > 0.0 ? S : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    const BatchView adjusted(Span<const double>(ws.spots.data(), n), batch.K, batch.r,
+                             batch.sigma, batch.T, batch.option_type);
+    price_batch(adjusted, prices);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "batch_pricer.hpp"
+#include "curves.hpp"
+#include "span.hpp"
+#include "workspace.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Cash dividends of one underlying: ex-dividend times in years from today and amounts.
+/// Any order; entries at or before today (time <= 0) are treated as already paid.
+struct DividendSchedule {
+    std::vector<double> ex_times;
+    std::vector<double> amounts;
+};
+
+/// Dividend schedules reduced once per batch to what the escrowed kernel reads per row:
+/// every underlying's future ex-times, ascending, with the running present value of its
+/// dividends, all in two flat arrays indexed by per-underlying offsets.
+class EscrowedDividends {
+  public:
+    /// Discount each dividend from its ex-time on `discount` (YieldCurve::flat(r) for the
+    /// flat-rate model). Throws std::invalid_argument if a schedule's columns differ in
+    /// length, an amount is negative or not finite, or an ex-time is not finite.
+    EscrowedDividends(Span<const DividendSchedule> schedules, const YieldCurve& discount);
+
+    std::size_t underlyings() const { return offsets_.size() - 1; }
+
+    /// Present value today of `underlying`'s dividends going ex in (0, T].
+    double present_value(std::size_t underlying, double T) const;
+
+  private:
+    std::vector<std::size_t> offsets_;  ///< Underlying u owns [offsets_[u], offsets_[u + 1])
+    std::vector<double> ex_times_;      ///< Ascending within each underlying
+    std::vector<double> cumulative_pv_; ///< PV of the dividends up to and including each
+};
+
+/// European prices under the escrowed-dividend model: row i is priced with Black-Scholes
+/// on spot S - PV(dividends of underlying[i] going ex before expiry), everything else
+/// from the row. Adjusted spots are written to ws.spots in one pass, then the unchanged
+/// batch kernel (streaming for large batches) prices a view that swaps in that column.
+/// Rows where the dividends' PV reaches the spot are priced as NaN. Allocation-free once
+/// `ws` is warm. Throws std::invalid_argument on length mismatches and std::out_of_range
+/// for an underlying index past dividends.underlyings().
+void price_batch_escrowed(const BatchView& batch, Span<const std::uint32_t> underlying,
+                          const EscrowedDividends& dividends, Span<double> prices,
+                          PricingWorkspace& ws);
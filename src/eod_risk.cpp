@@ -0,0 +1,289 @@
+#include "eod_risk.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr char SNAPSHOT_MAGIC[8]       = {'O', 'P', 'X', 'S', 'N', 'A', 'P', '1'};
+constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+
+struct SnapshotHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t rows;
+};
+
+struct FdGuard {
+    int fd;
+    ~FdGuard() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+};
+
+bool write_fully(int fd, const void* data, std::size_t bytes) {
+    const auto* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        const ssize_t n = write(fd, p, bytes);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        bytes -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+template <typename T>
+bool write_column(int fd, Span<const T> col) {
+    return write_fully(fd, col.data(), col.size() * sizeof(T));
+}
+
+/// fsync the directory holding `path`, so a rename into it survives a crash.
+/// Filesystems that cannot sync directories (EINVAL) are accepted as they are.
+bool sync_parent_dir(const std::string& path) {
+    const std::size_t slash = path.find_last_of('/');
+    const std::string dir   = slash == std::string::npos ? "."
+                              : slash == 0               ? "/"
+                                                         : path.substr(0, slash);
+    FdGuard fd{open(dir.c_str(), O_RDONLY | O_DIRECTORY)};
+    return fd.fd >= 0 && (fsync(fd.fd) == 0 || errno == EINVAL);
+}
+
+std::runtime_error file_error(const std::string& path) {
+    return std::runtime_error("save_snapshot: " + path + ": " + std::strerror(errno));
+}
+
+template <typename T, typename A>
+void read_column(std::ifstream& in, std::vector<T, A>& col, std::size_t n) {
+    col.resize(n);
+    in.read(reinterpret_cast<char*>(col.data()), static_cast<std::streamsize>(n * sizeof(T)));
+}
+
+/// Bytes per row across all columns: S, K, r, sigma, T, option_type, price.
+constexpr std::uint64_t ROW_BYTES = 6 * sizeof(double) + sizeof(OptionType);
+
+/// Read and validate a snapshot header; returns the row count. The count is checked
+/// against the file size before anyone sizes a column from it, so a corrupt header
+/// fails here instead of requesting a huge allocation.
+std::size_t read_header(std::ifstream& in, const std::string& path, const char* fn) {
+    SnapshotHeader header{};
+    in.read(reinterpret_cast<char*>(&header), sizeof header);
+    if (!in || std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof header.magic) != 0 ||
+        header.version != SNAPSHOT_VERSION) {
+        throw std::runtime_error(std::string(fn) + ": " + path + " is not a v1 risk snapshot");
+    }
+    in.seekg(0, std::ios::end);
+    const auto file_bytes = static_cast<std::uint64_t>(in.tellg());
+    in.seekg(sizeof header);
+    if (!in || header.rows > (file_bytes - sizeof header) / ROW_BYTES) {
+        throw std::runtime_error(std::string(fn) + ": " + path + " is truncated");
+    }
+    return header.rows;
+}
+
+/// Read rows [offset, offset + count) of the column starting at byte `start`.
+template <typename T, typename A>
+void read_rows(std::ifstream& in, std::uint64_t start, std::size_t offset, std::size_t count,
+               std::vector<T, A>& col) {
+    col.resize(count);
+    in.seekg(static_cast<std::streamoff>(start + offset * sizeof(T)));
+    in.read(reinterpret_cast<char*>(col.data()), static_cast<std::streamsize>(count * sizeof(T)));
+}
+
+/// changed[i] |= (a[i] != b[i]) bitwise, so NaN == NaN and -0.0 != +0.0 (any change in
+/// the stored input counts). Branch-free so the compiler vectorizes it.
+void diff_column(const double* a, const double* b, std::size_t n, std::uint8_t* changed) {
+    for (std::size_t i = 0; i < n; ++i) {
+        std::uint64_t x, y;
+        std::memcpy(&x, &a[i], sizeof x);
+        std::memcpy(&y, &b[i], sizeof y);
+        changed[i] |= static_cast<std::uint8_t>(x != y);
+    }
+}
+
+void diff_column(const OptionType* a, const OptionType* b, std::size_t n,
+                 std::uint8_t* changed) {
+    for (std::size_t i = 0; i < n; ++i) {
+        changed[i] |= static_cast<std::uint8_t>(a[i] != b[i]);
+    }
+}
+
+} // namespace
+
+void save_snapshot(const std::string& path, const BatchView& inputs, Span<const double> prices) {
+    const std::size_t n = inputs.size();
+    if (prices.size() != n) {
+        throw std::invalid_argument("save_snapshot: prices and inputs differ in length");
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof header.magic);
+    header.version = SNAPSHOT_VERSION;
+    header.rows    = n;
+
+    // Write and fsync a temporary file, rename it over `path`, then fsync the directory:
+    // a crash or full disk mid-write leaves yesterday's snapshot intact.
+    const std::string tmp = path + ".tmp";
+    {
+        FdGuard out{open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+        if (out.fd < 0) {
+            throw file_error(tmp);
+        }
+        const bool ok = write_fully(out.fd, &header, sizeof header) &&
+                        write_column(out.fd, inputs.S) && write_column(out.fd, inputs.K) &&
+                        write_column(out.fd, inputs.r) && write_column(out.fd, inputs.sigma) &&
+                        write_column(out.fd, inputs.T) &&
+                        write_column(out.fd, inputs.option_type) && write_column(out.fd, prices);
+        if (!ok || fsync(out.fd) != 0) {
+            const auto err = file_error(tmp);
+            std::remove(tmp.c_str());
+            throw err;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        const auto err = file_error(path);
+        std::remove(tmp.c_str());
+        throw err;
+    }
+    if (!sync_parent_dir(path)) {
+        throw file_error(path);
+    }
+}
+
+void save_snapshot(const std::string& path, const RiskSnapshot& snapshot) {
+    save_snapshot(path, snapshot.inputs, snapshot.prices);
+}
+
+RiskSnapshot load_snapshot(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("load_snapshot: cannot open " + path);
+    }
+
+    const std::size_t n = read_header(in, path, "load_snapshot");
+    RiskSnapshot snapshot;
+    ContractBatch& b = snapshot.inputs;
+    read_column(in, b.S, n);
+    read_column(in, b.K, n);
+    read_column(in, b.r, n);
+    read_column(in, b.sigma, n);
+    read_column(in, b.T, n);
+    read_column(in, b.option_type, n);
+    read_column(in, snapshot.prices, n);
+
+    if (!in) {
+        throw std::runtime_error("load_snapshot: " + path + " is truncated");
+    }
+    return snapshot;
+}
+
+SnapshotReader::SnapshotReader(const std::string& path)
+    : path_(path), in_(path, std::ios::binary) {
+    if (!in_) {
+        throw std::runtime_error("SnapshotReader: cannot open " + path);
+    }
+    rows_ = read_header(in_, path, "SnapshotReader");
+}
+
+void SnapshotReader::read(std::size_t offset, std::size_t count, ContractBatch& batch,
+                          Column<double>* prices) {
+    if (offset > rows_ || count > rows_ - offset) {
+        throw std::out_of_range("SnapshotReader::read: rows past the end of " + path_);
+    }
+    // Columns follow the header back to back: S, K, r, sigma, T, option_type, prices.
+    const std::uint64_t doubles = std::uint64_t{rows_} * sizeof(double);
+    std::uint64_t start         = sizeof(SnapshotHeader);
+    read_rows(in_, start, offset, count, batch.S);
+    read_rows(in_, start += doubles, offset, count, batch.K);
+    read_rows(in_, start += doubles, offset, count, batch.r);
+    read_rows(in_, start += doubles, offset, count, batch.sigma);
+    read_rows(in_, start += doubles, offset, count, batch.T);
+    read_rows(in_, start += doubles, offset, count, batch.option_type);
+    if (prices != nullptr) {
+        start += std::uint64_t{rows_} * sizeof(OptionType);
+        read_rows(in_, start, offset, count, *prices);
+    }
+    if (!in_) {
+        throw std::runtime_error("SnapshotReader::read: " + path_ + " is truncated");
+    }
+}
+
+std::size_t run_incremental(const ContractBatch& today, const RiskSnapshot& previous,
+                            Span<double> prices, PricingWorkspace& ws) {
+    const std::size_t n = today.size();
+    if (prices.size() != n) {
+        throw std::invalid_argument("run_incremental: output span length != batch size");
+    }
+    if (previous.prices.size() != previous.inputs.size()) {
+        throw std::invalid_argument(
+            "run_incremental: previous prices and inputs differ in length");
+    }
+    const std::size_t shared = std::min(n, previous.inputs.size());
+    const ContractBatch& old = previous.inputs;
+
+    // Rows past the previous run's end are new positions and always change.
+    std::vector<std::uint8_t>& changed = ws.mask;
+    changed.assign(n, 1);
+    std::fill(changed.begin(), changed.begin() + shared, 0);
+    diff_column(today.S.data(), old.S.data(), shared, changed.data());
+    diff_column(today.K.data(), old.K.data(), shared, changed.data());
+    diff_column(today.r.data(), old.r.data(), shared, changed.data());
+    diff_column(today.sigma.data(), old.sigma.data(), shared, changed.data());
+    diff_column(today.T.data(), old.T.data(), shared, changed.data());
+    diff_column(today.option_type.data(), old.option_type.data(), shared, changed.data());
+
+    std::copy(previous.prices.begin(), previous.prices.begin() + shared, prices.begin());
+
+    ws.rows.clear();
+    ws.gather.clear();
+    for (std::size_t i = 0; i < n; ++i) {
+        if (changed[i] != 0) {
+            ws.rows.push_back(i);
+            ws.gather.push_back(Contract{today.S[i], today.K[i], today.r[i], today.sigma[i],
+                                         today.T[i], today.option_type[i]});
+        }
+    }
+
+    ws.prices.resize(ws.rows.size());
+    price_batch(ws.gather, ws.prices);
+    for (std::size_t j = 0; j < ws.rows.size(); ++j) {
+        prices[ws.rows[j]] = ws.prices[j];
+    }
+
+    return ws.rows.size();
+}
+
+IncrementalRunResult run_incremental(const ContractBatch& today, const RiskSnapshot& previous) {
+    PricingWorkspace ws;
+    IncrementalRunResult result;
+    result.prices.resize(today.size());
+    result.recomputed = run_incremental(today, previous, result.prices, ws);
+    return result;
+}
+
+IncrementalRunResult run_eod(const ContractBatch& today, const std::string& snapshot_path) {
+    RiskSnapshot previous;
+    if (std::ifstream(snapshot_path).good()) {
+        previous = load_snapshot(snapshot_path);
+    }
+
+    IncrementalRunResult result = run_incremental(today, previous);
+    save_snapshot(snapshot_path, today, result.prices);
+    return result;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "batch_pricer.hpp"
+#include "workspace.hpp"
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/// Inputs and prices of one risk run, persisted so the next run can diff against it.
+/// Row i is the same position in both runs.
+struct RiskSnapshot {
+    ContractBatch inputs;
+    Column<double> prices;
+};
+
+/// Write a snapshot as a flat binary file: header, then each column contiguously.
+/// Uses native byte order; snapshots are meant to be read back on the same host type.
+/// The file is written to `path`.tmp, fsynced and renamed over `path`, so a failed or
+/// interrupted save leaves the previous snapshot in place.
+/// Throws std::invalid_argument if prices.size() != inputs.size() and
+/// std::runtime_error on I/O failure.
+void save_snapshot(const std::string& path, const BatchView& inputs, Span<const double> prices);
+
+/// save_snapshot for an owned snapshot.
+void save_snapshot(const std::string& path, const RiskSnapshot& snapshot);
+
+/// Read a snapshot written by save_snapshot.
+/// Throws std::runtime_error if the file is missing, truncated, or not a snapshot.
+RiskSnapshot load_snapshot(const std::string& path);
+
+/// Reads row ranges of a snapshot file without loading it, so files larger than memory
+/// can be processed chunk by chunk. Each column is read with one seek per range.
+class SnapshotReader {
+  public:
+    /// Throws std::runtime_error if the file is missing or not a snapshot.
+    explicit SnapshotReader(const std::string& path);
+
+    std::size_t size() const { return rows_; }
+
+    /// Rows [offset, offset + count) into `batch` (and `prices`, if given), replacing
+    /// their contents; the columns' capacity is reused across calls.
+    /// Throws std::out_of_range past the end and std::runtime_error on a short read.
+    void read(std::size_t offset, std::size_t count, ContractBatch& batch,
+              Column<double>* prices = nullptr);
+
+  private:
+    std::string path_;
+    std::ifstream in_;
+    std::size_t rows_ = 0;
+};
+
+/// Result of an incremental run: a full price vector plus how much was repriced.
+struct IncrementalRunResult {
+    Column<double> prices;  ///< One price per input row, in row order
+    std::size_t recomputed; ///< Rows that went through price_batch
+
+    double fraction_recomputed() const {
+        return prices.empty() ? 0.0 : static_cast<double>(recomputed) / prices.size();
+    }
+};
+
+/// Price `today`, reusing `previous` prices for rows whose inputs are bit-identical.
+/// Inputs are compared column by column; changed rows (and rows beyond the previous
+/// run's length) are gathered into one batch for price_batch and scattered back.
+/// Throws std::invalid_argument if previous.prices.size() != previous.inputs.size().
+IncrementalRunResult run_incremental(const ContractBatch& today, const RiskSnapshot& previous);
+
+/// Span form of run_incremental: writes one price per row of `today` into `prices` and
+/// returns the number of rows recomputed. Allocation-free once `ws` is warm.
+/// Throws std::invalid_argument if prices.size() != today.size() or if `previous` has a
+/// different number of prices than inputs.
+std::size_t run_incremental(const ContractBatch& today, const RiskSnapshot& previous,
+                            Span<double> prices, PricingWorkspace& ws);
+
+/// End-of-day run mode: diff against the snapshot at `snapshot_path` if it exists
+/// (full repricing otherwise), then overwrite it with today's inputs and prices.
+IncrementalRunResult run_eod(const ContractBatch& today, const std::string& snapshot_path);
@@ -0,0 +1,138 @@
+#include "grid.hpp"
+
+#include "bs_kernel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+/// Grid points per parallel task.
+constexpr std::size_t GRID_CHUNK = 4096;
+
+/// Value of axis `values` at index i, or the base value for a fixed axis.
+inline double axis_at(const std::vector<double>& values, std::size_t i, double base) {
+    return values.empty() ? base : values[i];
+}
+
+/// Run body(begin, end) over [0, n) in GRID_CHUNK pieces, on `pool` if given.
+template <typename Body> void for_chunks(std::size_t n, ThreadPool* pool, const Body& body) {
+    const std::size_t chunks = (n + GRID_CHUNK - 1) / GRID_CHUNK;
+    const auto run           = [&](std::size_t c) {
+        body(c * GRID_CHUNK, std::min(n, (c + 1) * GRID_CHUNK));
+    };
+    if (pool != nullptr && chunks > 1) {
+        pool->parallel_for(chunks, run);
+    } else {
+        for (std::size_t c = 0; c < chunks; ++c) {
+            run(c);
+        }
+    }
+}
+
+/// Fill ws.prepared with one PreparedContract per (K, r, sigma, T) combination, T fastest.
+void prepare_combinations(const Contract& base, const GridAxes& axes, PricingWorkspace& ws,
+                          ThreadPool* pool) {
+    const auto shape         = axes.shape();
+    const std::size_t combos = shape[1] * shape[2] * shape[3] * shape[4];
+    ws.prepared.resize(combos);
+
+    for_chunks(combos, pool, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t m = begin; m < end; ++m) {
+            std::size_t rest    = m;
+            const std::size_t t = rest % shape[4];
+            rest /= shape[4];
+            const std::size_t v = rest % shape[3];
+            rest /= shape[3];
+            const std::size_t r = rest % shape[2];
+            const std::size_t k = rest / shape[2];
+            ws.prepared[m] = prepare_contract(axis_at(axes.K, k, base.K),
+                                              axis_at(axes.r, r, base.r),
+                                              axis_at(axes.sigma, v, base.sigma),
+                                              axis_at(axes.T, t, base.T), base.option_type);
+        }
+    });
+}
+
+/// Evaluate f(prepared, S, ln S) at every grid point into out[0..axes.size()).
+template <typename T, typename F>
+void sweep(const Contract& base, const GridAxes& axes, T* out, PricingWorkspace& ws,
+           ThreadPool* pool, const F& f) {
+    prepare_combinations(base, axes, ws, pool);
+    const std::size_t combos      = ws.prepared.size();
+    const PreparedContract* table = ws.prepared.data();
+
+    for_chunks(axes.size(), pool, [&](std::size_t begin, std::size_t end) {
+        std::size_t s = begin / combos;
+        std::size_t m = begin % combos;
+        double S      = axis_at(axes.S, s, base.S);
+        double log_S  = std::log(S);
+        for (std::size_t i = begin; i < end; ++i) {
+            out[i] = f(table[m], S, log_S);
+            if (++m == combos && i + 1 < end) {
+                m     = 0;
+                S     = axis_at(axes.S, ++s, base.S);
+                log_S = std::log(S);
+            }
+        }
+    });
+}
+
+void check_output(std::size_t expected, std::size_t actual, const char* fn) {
+    if (expected != actual) {
+        throw std::invalid_argument(std::string(fn) + ": output has " + std::to_string(actual) +
+                                    " elements, grid has " + std::to_string(expected));
+    }
+}
+
+} // namespace
+
+std::array<std::size_t, 5> GridAxes::shape() const {
+    const auto len = [](const std::vector<double>& a) {
+        return std::max<std::size_t>(1, a.size());
+    };
+    return {len(S), len(K), len(r), len(sigma), len(T)};
+}
+
+std::size_t GridAxes::size() const {
+    std::size_t n = 1;
+    for (const std::size_t d : shape()) {
+        n *= d;
+    }
+    return n;
+}
+
+void price_grid(const Contract& base, const GridAxes& axes, Span<double> prices,
+                PricingWorkspace& ws, ThreadPool* pool) {
+    check_output(axes.size(), prices.size(), "price_grid");
+    sweep(base, axes, prices.data(), ws, pool,
+          [](const PreparedContract& p, double S, double log_S) {
+              return prepared_price(p, S, log_S);
+          });
+}
+
+void greeks_grid(const Contract& base, const GridAxes& axes, Span<Valuation> values,
+                 PricingWorkspace& ws, ThreadPool* pool) {
+    check_output(axes.size(), values.size(), "greeks_grid");
+    sweep(base, axes, values.data(), ws, pool,
+          [](const PreparedContract& p, double S, double log_S) {
+              return prepared_valuation(p, S, log_S);
+          });
+}
+
+std::vector<double> price_grid(const Contract& base, const GridAxes& axes, ThreadPool* pool) {
+    std::vector<double> prices(axes.size());
+    PricingWorkspace ws;
+    price_grid(base, axes, prices, ws, pool);
+    return prices;
+}
+
+std::vector<Valuation> greeks_grid(const Contract& base, const GridAxes& axes,
+                                   ThreadPool* pool) {
+    std::vector<Valuation> values(axes.size());
+    PricingWorkspace ws;
+    greeks_grid(base, axes, values, ws, pool);
+    return values;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "batch_pricer.hpp"
+#include "black_scholes.hpp"
+#include "span.hpp"
+#include "thread_pool.hpp"
+#include "workspace.hpp"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+/// Axes of a parameter sweep around a base contract. Each non-empty axis replaces the
+/// base contract's value; an empty axis holds it fixed. The grid is the Cartesian
+/// product of the axes, stored row-major in the order S, K, r, sigma, T (S slowest).
+struct GridAxes {
+    std::vector<double> S;
+    std::vector<double> K;
+    std::vector<double> r;
+    std::vector<double> sigma;
+    std::vector<double> T;
+
+    /// Points along each axis in storage order; 1 for a fixed axis.
+    std::array<std::size_t, 5> shape() const;
+
+    /// Total number of grid points (product of shape()).
+    std::size_t size() const;
+};
+
+/// Price `base` at every point of the grid, writing prices in row-major order.
+///
+/// Every (K, r, sigma, T) combination is prepared once (ln K, drift, σ√T, K·e^(-rT))
+/// into ws.prepared, and ln S is taken once per spot, so the per-point work is two CDF
+/// evaluations. Points are split into fixed chunks across `pool` when given; results do
+/// not depend on the pool. Same conventions as price_option (T and sigma must be
+/// positive). Allocation-free once `ws` is warm.
+/// Throws std::invalid_argument if prices.size() != axes.size().
+void price_grid(const Contract& base, const GridAxes& axes, Span<double> prices,
+                PricingWorkspace& ws, ThreadPool* pool = nullptr);
+
+/// Price and Greeks of `base` at every grid point; same layout and hoisting as price_grid.
+void greeks_grid(const Contract& base, const GridAxes& axes, Span<Valuation> values,
+                 PricingWorkspace& ws, ThreadPool* pool = nullptr);
+
+/// Allocating convenience forms of the above.
+std::vector<double> price_grid(const Contract& base, const GridAxes& axes,
+                               ThreadPool* pool = nullptr);
+std::vector<Valuation> greeks_grid(const Contract& base, const GridAxes& axes,
+                                   ThreadPool* pool = nullptr);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "arena.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/// Process-wide switch for HugePageAllocator's large-allocation path. On by default;
+/// turning it off maps large columns with base pages only, for A/B measurements.
+/// Affects allocations made after the call.
+inline std::atomic<bool>& huge_page_columns_flag() {
+    static std::atomic<bool> enabled{true};
+    return enabled;
+}
+inline void set_huge_page_columns(bool enabled) { huge_page_columns_flag().store(enabled); }
+inline bool huge_page_columns() { return huge_page_columns_flag().load(); }
+
+/// Allocator for SoA batch columns and result buffers.
+///
+/// Small columns come from 64-byte aligned operator new (cache-line aligned for the
+/// batch kernels). Columns of HUGE_PAGE_SIZE or more are mapped directly with
+/// map_pages, so a 10M-contract column spans a few dozen 2 MB TLB entries instead of
+/// tens of thousands of 4 KB ones; if no huge pages are available the mapping falls
+/// back to base pages.
+template <typename T> struct HugePageAllocator {
+    using value_type = T;
+
+    static constexpr std::size_t ALIGNMENT = 64;
+
+    HugePageAllocator() = default;
+    template <typename U> HugePageAllocator(const HugePageAllocator<U>&) {}
+
+    T* allocate(std::size_t n) {
+        const std::size_t bytes = n * sizeof(T);
+        if (bytes >= HUGE_PAGE_SIZE) {
+            return static_cast<T*>(map_pages(bytes, huge_page_columns()).data);
+        }
+        return static_cast<T*>(::operator new(bytes, std::align_val_t{ALIGNMENT}));
+    }
+
+    void deallocate(T* p, std::size_t n) {
+        const std::size_t bytes = n * sizeof(T);
+        if (bytes >= HUGE_PAGE_SIZE) {
+            unmap_pages(PageBlock{p, mapped_bytes(bytes), PageKind::REGULAR});
+            return;
+        }
+        ::operator delete(p, std::align_val_t{ALIGNMENT});
+    }
+
+    template <typename U> bool operator==(const HugePageAllocator<U>&) const { return true; }
+    template <typename U> bool operator!=(const HugePageAllocator<U>&) const { return false; }
+};
+
+/// Storage for one SoA column or result buffer.
+template <typename T> using Column = std::vector<T, HugePageAllocator<T>>;
@@ -0,0 +1,304 @@
+#include "price_cache.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr std::size_t WAYS       = 8; ///< Entries per bucket
+constexpr std::size_t KEY_WORDS  = 6; ///< Quantized S, K, r, sigma, T, plus option type
+constexpr std::size_t VALUE_WORDS = 5; ///< price, delta, gamma, vega, theta
+
+static_assert(sizeof(CacheEntryImage::key) == KEY_WORDS * sizeof(std::uint64_t) &&
+                  sizeof(CacheEntryImage::value) == VALUE_WORDS * sizeof(double),
+              "CacheEntryImage must mirror the entry layout");
+
+/// Option-type key word of a cleared entry; real keys hold 0 or 1 there, so it never matches.
+constexpr std::size_t TYPE_WORD     = KEY_WORDS - 1;
+constexpr std::uint64_t CLEARED_KEY = ~std::uint64_t{0};
+
+/// Largest |x / step| that is keyed; beyond it (or for NaN and infinities) llround has no
+/// specified result, so such inputs bypass the cache.
+constexpr double MAX_QUANTUM = 4.0e18;
+
+/// x / step rounded to the nearest multiple into `out`; false if it cannot be keyed.
+inline bool quantize(double x, double step, std::uint64_t& out) {
+    const double q = x / step;
+    if (!(std::abs(q) < MAX_QUANTUM)) { // also rejects NaN
+        return false;
+    }
+    out = static_cast<std::uint64_t>(std::llround(q));
+    return true;
+}
+
+/// A zero, negative or NaN step makes every quantize() fail, turning the cache into a
+/// silent 100% miss path, so it is rejected up front.
+void check_step(double step, const char* name) {
+    if (!(std::isfinite(step) && step > 0.0)) {
+        throw std::invalid_argument(std::string("PricingCache: tolerance ") + name +
+                                    " must be finite and positive, got " +
+                                    std::to_string(step));
+    }
+}
+
+inline std::uint64_t to_bits(double x) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &x, sizeof bits);
+    return bits;
+}
+
+inline double from_bits(std::uint64_t bits) {
+    double x;
+    std::memcpy(&x, &bits, sizeof x);
+    return x;
+}
+
+/// Final avalanche step from MurmurHash3 (fmix64).
+inline std::uint64_t mix(std::uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+inline std::uint64_t hash_words(const std::uint64_t* words) {
+    std::uint64_t h = 0;
+    for (std::size_t i = 0; i < KEY_WORDS; ++i) {
+        h = mix(h ^ words[i]);
+    }
+    return h;
+}
+
+} // namespace
+
+/// One cached result. `version` is a seqlock: 0 = never written, odd = write in progress.
+/// Key and value words are relaxed atomics so torn reads are detected, never undefined.
+struct PricingCache::Entry {
+    std::atomic<std::uint32_t> version;
+    std::atomic<std::uint8_t> referenced; ///< Clock bit, set on hit, cleared by the sweep
+    std::atomic<std::uint64_t> key[KEY_WORDS];
+    std::atomic<std::uint64_t> value[VALUE_WORDS];
+};
+
+struct PricingCache::Key {
+    std::uint64_t words[KEY_WORDS];
+    std::uint64_t hash;
+};
+
+PricingCache::PricingCache(const CacheConfig& config) : tol_(config.tolerances) {
+    check_step(tol_.S, "S");
+    check_step(tol_.K, "K");
+    check_step(tol_.r, "r");
+    check_step(tol_.sigma, "sigma");
+    check_step(tol_.T, "T");
+
+    std::size_t buckets = 1;
+    while (buckets * WAYS < config.capacity) {
+        buckets <<= 1;
+    }
+    bucket_mask_ = buckets - 1;
+    entries_.reset(new Entry[buckets * WAYS]()); // value-init zeroes every atomic
+    clock_hands_.reset(new std::atomic<std::uint32_t>[buckets]());
+}
+
+PricingCache::~PricingCache() = default;
+
+std::size_t PricingCache::capacity() const { return (bucket_mask_ + 1) * WAYS; }
+
+bool PricingCache::make_key(double S, double K, double r, double sigma, double T,
+                            OptionType type, Key& key) const {
+    if (!quantize(S, tol_.S, key.words[0]) || !quantize(K, tol_.K, key.words[1]) ||
+        !quantize(r, tol_.r, key.words[2]) || !quantize(sigma, tol_.sigma, key.words[3]) ||
+        !quantize(T, tol_.T, key.words[4])) {
+        return false;
+    }
+    key.words[TYPE_WORD] = static_cast<std::uint64_t>(type);
+    key.hash             = hash_words(key.words);
+    return true;
+}
+
+bool PricingCache::lookup(const Key& key, double* values) const {
+    Entry* bucket = &entries_[(key.hash & bucket_mask_) * WAYS];
+
+    for (std::size_t w = 0; w < WAYS; ++w) {
+        Entry& e                = bucket[w];
+        const std::uint32_t v1 = e.version.load(std::memory_order_acquire);
+        if (v1 == 0 || (v1 & 1) != 0) {
+            continue; // empty or mid-write
+        }
+
+        bool match = true;
+        for (std::size_t i = 0; i < KEY_WORDS && match; ++i) {
+            match = e.key[i].load(std::memory_order_relaxed) == key.words[i];
+        }
+        if (!match) {
+            continue;
+        }
+
+        std::uint64_t bits[VALUE_WORDS];
+        for (std::size_t i = 0; i < VALUE_WORDS; ++i) {
+            bits[i] = e.value[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e.version.load(std::memory_order_relaxed) != v1) {
+            continue; // overwritten while reading; treat as a miss
+        }
+
+        for (std::size_t i = 0; i < VALUE_WORDS; ++i) {
+            values[i] = from_bits(bits[i]);
+        }
+        if (e.referenced.load(std::memory_order_relaxed) == 0) {
+            // Test first to avoid dirtying the line on every hit
+            e.referenced.store(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool PricingCache::insert(const Key& key, const double* values) {
+    const std::size_t b = key.hash & bucket_mask_;
+    Entry* bucket       = &entries_[b * WAYS];
+
+    // Clock sweep: skip (and clear) recently referenced ways; give up after two laps
+    // rather than block if other writers hold every candidate.
+    for (std::size_t attempt = 0; attempt < 2 * WAYS; ++attempt) {
+        Entry& e = bucket[clock_hands_[b].fetch_add(1, std::memory_order_relaxed) % WAYS];
+        if (e.referenced.exchange(0, std::memory_order_relaxed) != 0) {
+            continue;
+        }
+
+        std::uint32_t v = e.version.load(std::memory_order_relaxed);
+        if ((v & 1) != 0 ||
+            !e.version.compare_exchange_strong(v, v + 1, std::memory_order_acquire)) {
+            continue; // another writer owns this way
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        const bool occupied =
+            v != 0 && e.key[TYPE_WORD].load(std::memory_order_relaxed) != CLEARED_KEY;
+
+        for (std::size_t i = 0; i < KEY_WORDS; ++i) {
+            e.key[i].store(key.words[i], std::memory_order_relaxed);
+        }
+        for (std::size_t i = 0; i < VALUE_WORDS; ++i) {
+            e.value[i].store(to_bits(values[i]), std::memory_order_relaxed);
+        }
+        e.version.store(v + 2, std::memory_order_release);
+
+        if (occupied) {
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+    return false;
+}
+
+void PricingCache::fetch(double S, double K, double r, double sigma, double T, OptionType type,
+                         double* values) {
+    Key key;
+    const bool keyed = make_key(S, K, r, sigma, T, type, key);
+    if (keyed && lookup(key, values)) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+
+    // Fill both halves on a miss so a later price() or greeks() call for the same quote hits.
+    const Greeks g = compute_greeks(S, K, r, sigma, T, type);
+    values[0]      = price_option(S, K, r, sigma, T, type);
+    values[1]      = g.delta;
+    values[2]      = g.gamma;
+    values[3]      = g.vega;
+    values[4]      = g.theta;
+    if (keyed) {
+        insert(key, values);
+    }
+}
+
+double PricingCache::price(double S, double K, double r, double sigma, double T,
+                           OptionType type) {
+    double values[VALUE_WORDS];
+    fetch(S, K, r, sigma, T, type, values);
+    return values[0];
+}
+
+Greeks PricingCache::greeks(double S, double K, double r, double sigma, double T,
+                            OptionType type) {
+    double values[VALUE_WORDS];
+    fetch(S, K, r, sigma, T, type, values);
+    return Greeks{values[1], values[2], values[3], values[4]};
+}
+
+CacheStats PricingCache::stats() const {
+    return CacheStats{hits_.load(std::memory_order_relaxed),
+                      misses_.load(std::memory_order_relaxed),
+                      evictions_.load(std::memory_order_relaxed)};
+}
+
+void PricingCache::clear() {
+    // Versions only ever grow: resetting one to 0 under a concurrent reader could let a
+    // torn read validate against a recycled version. Instead each filled entry is taken
+    // like a writer would take it and its type word overwritten with CLEARED_KEY.
+    const std::size_t n = capacity();
+    for (std::size_t i = 0; i < n; ++i) {
+        Entry& e        = entries_[i];
+        std::uint32_t v = e.version.load(std::memory_order_relaxed);
+        while (v != 0 &&
+               ((v & 1) != 0 ||
+                !e.version.compare_exchange_weak(v, v + 1, std::memory_order_acquire))) {
+            v = e.version.load(std::memory_order_relaxed); // a writer holds it briefly
+        }
+        if (v == 0) {
+            continue; // never written
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        e.key[TYPE_WORD].store(CLEARED_KEY, std::memory_order_relaxed);
+        e.referenced.store(0, std::memory_order_relaxed);
+        e.version.store(v + 2, std::memory_order_release);
+    }
+    hits_.store(0, std::memory_order_relaxed);
+    misses_.store(0, std::memory_order_relaxed);
+    evictions_.store(0, std::memory_order_relaxed);
+}
+
+void PricingCache::dump(std::vector<CacheEntryImage>& out) const {
+    const std::size_t n = capacity();
+    for (std::size_t i = 0; i < n; ++i) {
+        const Entry& e         = entries_[i];
+        const std::uint32_t v1 = e.version.load(std::memory_order_acquire);
+        if (v1 == 0 || (v1 & 1) != 0) {
+            continue;
+        }
+        CacheEntryImage image;
+        for (std::size_t k = 0; k < KEY_WORDS; ++k) {
+            image.key[k] = e.key[k].load(std::memory_order_relaxed);
+        }
+        for (std::size_t k = 0; k < VALUE_WORDS; ++k) {
+            image.value[k] = from_bits(e.value[k].load(std::memory_order_relaxed));
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e.version.load(std::memory_order_relaxed) != v1 ||
+            image.key[TYPE_WORD] == CLEARED_KEY) {
+            continue; // rewritten while reading, or cleared
+        }
+        out.push_back(image);
+    }
+}
+
+std::size_t PricingCache::warm(Span<const CacheEntryImage> entries) {
+    std::size_t stored = 0;
+    for (const CacheEntryImage& image : entries) {
+        if (image.key[TYPE_WORD] == CLEARED_KEY) {
+            continue;
+        }
+        Key key;
+        std::memcpy(key.words, image.key, sizeof key.words);
+        key.hash = hash_words(key.words);
+        stored += insert(key, image.value) ? 1 : 0;
+    }
+    return stored;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "black_scholes.hpp"
+#include "span.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// Quantization step per input. Requests whose inputs round to the same multiple of
+/// every step share one cache entry, so a step is "how much change still counts as
+/// the same quote".
+struct CacheTolerances {
+    double S     = 1e-4; ///< Spot tick
+    double K     = 1e-4; ///< Strike tick
+    double r     = 1e-6; ///< Rate tick
+    double sigma = 1e-6; ///< Vol tick
+    double T     = 1e-8; ///< Time tick in years (~0.3 s)
+};
+
+/// Sizing and keying for a PricingCache.
+struct CacheConfig {
+    std::size_t capacity = 1 << 16; ///< Max entries; rounded up to a multiple of the bucket width
+    CacheTolerances tolerances{};
+};
+
+/// Cache counters since construction or the last clear().
+struct CacheStats {
+    std::uint64_t hits;
+    std::uint64_t misses;
+    std::uint64_t evictions;
+};
+
+/// One filled cache entry in portable form, for persisting a warm cache across restarts
+/// (PricingCache::dump / PricingCache::warm). Keys are only meaningful under the
+/// tolerances they were quantized with.
+struct CacheEntryImage {
+    std::uint64_t key[6]; ///< Quantized S, K, r, sigma, T, then the option type
+    double value[5];      ///< price, delta, gamma, vega, theta
+};
+
+/// Bounded, thread-safe memoization of price_option / compute_greeks on quantized inputs.
+///
+/// Entries live in fixed 8-way buckets. Reads are lock-free (per-entry seqlock); a miss
+/// computes price and Greeks together, then claims a way in the bucket with a clock
+/// (second-chance) sweep, so hot quotes survive while stale ones are evicted.
+/// A hit returns the values computed for the first request that populated the entry.
+/// Requests with a non-finite input, or one too large to quantize, are computed directly.
+class PricingCache {
+  public:
+    /// Throws std::invalid_argument if any tolerance is not finite and positive.
+    explicit PricingCache(const CacheConfig& config = CacheConfig{});
+    ~PricingCache();
+
+    PricingCache(const PricingCache&)            = delete;
+    PricingCache& operator=(const PricingCache&) = delete;
+
+    /// Same contract as price_option, served from the cache when possible.
+    double price(double S, double K, double r, double sigma, double T, OptionType type);
+
+    /// Same contract as compute_greeks, served from the cache when possible.
+    Greeks greeks(double S, double K, double r, double sigma, double T, OptionType type);
+
+    CacheStats stats() const;
+
+    /// Drop every entry and reset counters. Safe to call concurrently with lookups: each
+    /// entry is invalidated under its seqlock. Entries inserted while clear() runs may
+    /// survive it, and counter updates racing with the reset may be lost.
+    void clear();
+
+    std::size_t capacity() const;
+
+    const CacheTolerances& tolerances() const { return tol_; }
+
+    /// Append every filled entry to `out`. Safe to call concurrently with lookups; entries
+    /// being rewritten at that moment are skipped.
+    void dump(std::vector<CacheEntryImage>& out) const;
+
+    /// Insert previously dumped entries and return how many were stored. Hits and misses
+    /// are not counted; entries beyond a bucket's ways evict as a miss would. The images
+    /// must come from a cache with the same tolerances.
+    std::size_t warm(Span<const CacheEntryImage> entries);
+
+  private:
+    struct Entry;
+    struct Key;
+
+    /// False if an input is not finite or too large for its step; such requests are
+    /// computed directly and never cached.
+    bool make_key(double S, double K, double r, double sigma, double T, OptionType type,
+                  Key& key) const;
+    bool lookup(const Key& key, double* values) const;
+    bool insert(const Key& key, const double* values);
+    void fetch(double S, double K, double r, double sigma, double T, OptionType type,
+               double* values);
+
+    CacheTolerances tol_;
+    std::size_t bucket_mask_;
+    std::unique_ptr<Entry[]> entries_;
+    std::unique_ptr<std::atomic<std::uint32_t>[]> clock_hands_; // one per bucket
+
+    alignas(64) std::atomic<std::uint64_t> hits_{0}; // own cache line, away from config
+    std::atomic<std::uint64_t> misses_{0};
+    std::atomic<std::uint64_t> evictions_{0};
+};
@@ -0,0 +1,113 @@
+#include "pricing_graph.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+PricingGraph::NodeId PricingGraph::add_input(InputKind kind, double value) {
+    node_kind_.push_back(kind);
+    node_value_.push_back(value);
+    dependents_.emplace_back();
+    return node_kind_.size() - 1;
+}
+
+std::size_t PricingGraph::add_contract(NodeId spot, NodeId rate, NodeId vol, double K, double T,
+                                       OptionType type) {
+    const auto check = [this](NodeId node, InputKind kind, const char* what) {
+        if (node >= node_kind_.size() || node_kind_[node] != kind) {
+            throw std::invalid_argument(std::string("PricingGraph::add_contract: bad ") + what +
+                                        " node");
+        }
+    };
+    check(spot, InputKind::SPOT, "spot");
+    check(rate, InputKind::RATE, "rate");
+    check(vol, InputKind::VOL, "vol");
+
+    const std::size_t id = K_.size();
+    spot_node_.push_back(spot);
+    rate_node_.push_back(rate);
+    vol_node_.push_back(vol);
+    K_.push_back(K);
+    T_.push_back(T);
+    type_.push_back(type);
+    prices_.push_back(0.0);
+    dirty_.push_back(0);
+
+    dependents_[spot].push_back(id);
+    dependents_[rate].push_back(id);
+    dependents_[vol].push_back(id);
+
+    mark_dirty(id); // never priced yet
+    return id;
+}
+
+void PricingGraph::set_input(NodeId node, double value) {
+    if (node >= node_value_.size()) {
+        throw std::out_of_range("PricingGraph::set_input: unknown node");
+    }
+    if (node_value_[node] == value) {
+        return;
+    }
+    node_value_[node] = value;
+    for (const std::size_t c : dependents_[node]) {
+        mark_dirty(c);
+    }
+}
+
+double PricingGraph::input(NodeId node) const { return node_value_.at(node); }
+
+double PricingGraph::price(std::size_t contract) {
+    if (contract >= prices_.size()) {
+        throw std::out_of_range("PricingGraph::price: unknown contract");
+    }
+    flush();
+    return prices_[contract];
+}
+
+const Column<double>& PricingGraph::prices() {
+    flush();
+    return prices_;
+}
+
+void PricingGraph::mark_dirty(std::size_t contract) {
+    if (dirty_[contract] == 0) {
+        dirty_[contract] = 1;
+        dirty_list_.push_back(contract);
+    }
+}
+
+void PricingGraph::flush() {
+    if (dirty_list_.empty()) {
+        return;
+    }
+    const auto t0 = std::chrono::steady_clock::now();
+
+    // Gather dirty contracts with their current inputs into one SoA batch.
+    gather_.clear();
+    gather_.reserve(dirty_list_.size());
+    for (const std::size_t c : dirty_list_) {
+        gather_.push_back(Contract{node_value_[spot_node_[c]], K_[c], node_value_[rate_node_[c]],
+                                   node_value_[vol_node_[c]], T_[c], type_[c]});
+    }
+
+    fresh_.resize(gather_.size());
+    price_batch(gather_, fresh_);
+
+    for (std::size_t i = 0; i < dirty_list_.size(); ++i) {
+        const std::size_t c = dirty_list_[i];
+        prices_[c]          = fresh_[i];
+        dirty_[c]           = 0;
+    }
+
+    const auto t1 = std::chrono::steady_clock::now();
+    const std::int64_t ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+
+    stats_.last_recomputed = dirty_list_.size();
+    stats_.total_recomputed += dirty_list_.size();
+    ++stats_.flushes;
+    stats_.last_recompute_ns = ns;
+    stats_.total_recompute_ns += ns;
+
+    dirty_list_.clear();
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "batch_pricer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Kinds of market input a contract can depend on.
+enum class InputKind { SPOT, RATE, VOL };
+
+/// Recompute counters for a PricingGraph.
+struct GraphStats {
+    std::size_t last_recomputed;     ///< Contracts re-evaluated by the most recent flush
+    std::size_t total_recomputed;    ///< Contracts re-evaluated since construction
+    std::size_t flushes;             ///< Reads that found dirty contracts
+    std::int64_t last_recompute_ns;  ///< Wall time of the most recent flush
+    std::int64_t total_recompute_ns; ///< Wall time of all flushes
+};
+
+/// Lazily repriced portfolio.
+///
+/// Market inputs (spots, rates, vol slices) are nodes; each contract depends on one
+/// node of each kind. Changing an input only marks its dependents dirty. The next read
+/// gathers every dirty contract into an SoA batch, prices it with price_batch, and
+/// scatters the results back, so a market update costs nothing until someone looks.
+class PricingGraph {
+  public:
+    using NodeId = std::size_t;
+
+    /// Add a market input node with an initial value.
+    NodeId add_input(InputKind kind, double value);
+
+    /// Add a contract depending on the given spot, rate and vol nodes.
+    /// Throws std::invalid_argument if a node id is unknown or of the wrong kind.
+    std::size_t add_contract(NodeId spot, NodeId rate, NodeId vol, double K, double T,
+                             OptionType type);
+
+    /// Update a market input. Dependents are marked dirty only if the value changed.
+    void set_input(NodeId node, double value);
+
+    double input(NodeId node) const;
+
+    /// Price of one contract, re-evaluating all dirty contracts first.
+    double price(std::size_t contract);
+
+    /// Prices of every contract in insertion order, re-evaluating dirty ones first.
+    const Column<double>& prices();
+
+    /// Contracts waiting to be re-evaluated.
+    std::size_t dirty_count() const { return dirty_list_.size(); }
+
+    std::size_t size() const { return K_.size(); }
+
+    const GraphStats& stats() const { return stats_; }
+
+  private:
+    void mark_dirty(std::size_t contract);
+    void flush();
+
+    // Input nodes
+    std::vector<InputKind> node_kind_;
+    std::vector<double> node_value_;
+    std::vector<std::vector<std::size_t>> dependents_; ///< node -> contracts that read it
+
+    // Contracts (static terms plus the nodes they read)
+    std::vector<NodeId> spot_node_;
+    std::vector<NodeId> rate_node_;
+    std::vector<NodeId> vol_node_;
+    std::vector<double> K_;
+    std::vector<double> T_;
+    std::vector<OptionType> type_;
+
+    Column<double> prices_;
+    std::vector<std::uint8_t> dirty_;
+    std::vector<std::size_t> dirty_list_;
+    ContractBatch gather_;      ///< Reused across flushes
+    Column<double> fresh_;      ///< Prices of gather_
+
+    GraphStats stats_{};
+};
@@ -0,0 +1,101 @@
+#include "projection.hpp"
+
+#include "bs_kernel.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+/// Terms of one contract that do not change as calendar time advances.
+struct DecayInvariants {
+    double S;
+    double K;
+    double r;
+    double sigma;
+    double T;
+    double log_m; ///< ln(S/K)
+    double mu;    ///< r + σ²/2
+    double w;     ///< payoff_sign(type)
+};
+
+DecayInvariants hoist(const ContractBatch& batch, std::size_t i) {
+    DecayInvariants inv{};
+    inv.S     = batch.S[i];
+    inv.K     = batch.K[i];
+    inv.r     = batch.r[i];
+    inv.sigma = batch.sigma[i];
+    inv.T     = batch.T[i];
+    inv.log_m = inv.S > 0.0 && inv.K > 0.0 ? std::log(inv.S / inv.K) : 0.0;
+    inv.mu    = inv.r + 0.5 * inv.sigma * inv.sigma;
+    inv.w     = payoff_sign(batch.option_type[i]);
+    return inv;
+}
+
+inline double value_at(const DecayInvariants& inv, double horizon_day) {
+    return guarded_value(inv.S, inv.K, inv.log_m, inv.r, inv.mu, inv.sigma,
+                         inv.T - horizon_day / DAYS_PER_YEAR, inv.w);
+}
+
+void check_size(std::size_t expected, std::size_t actual, const char* fn, const char* what) {
+    if (expected != actual) {
+        throw std::invalid_argument(std::string(fn) + ": " + what + " has " +
+                                    std::to_string(actual) + " elements, expected " +
+                                    std::to_string(expected));
+    }
+}
+
+} // namespace
+
+void project_time_decay(const ContractBatch& batch, Span<const double> horizon_days,
+                        Span<double> values) {
+    const std::size_t n = batch.size();
+    const std::size_t h = horizon_days.size();
+    check_size(n * h, values.size(), "project_time_decay", "values");
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const DecayInvariants inv = hoist(batch, i);
+        double* row               = values.data() + i * h;
+        for (std::size_t j = 0; j < h; ++j) {
+            row[j] = value_at(inv, horizon_days[j]);
+        }
+    }
+}
+
+void project_book_decay(const ContractBatch& batch, Span<const double> quantities,
+                        Span<const double> horizon_days, Span<double> totals) {
+    const std::size_t n = batch.size();
+    const std::size_t h = horizon_days.size();
+    check_size(n, quantities.size(), "project_book_decay", "quantities");
+    check_size(h, totals.size(), "project_book_decay", "totals");
+
+    for (std::size_t j = 0; j < h; ++j) {
+        totals[j] = 0.0;
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        const DecayInvariants inv = hoist(batch, i);
+        const double q            = quantities[i];
+        for (std::size_t j = 0; j < h; ++j) {
+            totals[j] += q * value_at(inv, horizon_days[j]);
+        }
+    }
+}
+
+DecayLadder project_time_decay(const ContractBatch& batch,
+                               const std::vector<double>& horizon_days) {
+    DecayLadder ladder;
+    ladder.contracts = batch.size();
+    ladder.horizons  = horizon_days.size();
+    ladder.values.resize(ladder.contracts * ladder.horizons);
+    project_time_decay(batch, horizon_days, ladder.values);
+    return ladder;
+}
+
+std::vector<double> project_book_decay(const ContractBatch& batch,
+                                       const std::vector<double>& quantities,
+                                       const std::vector<double>& horizon_days) {
+    std::vector<double> totals(horizon_days.size());
+    project_book_decay(batch, quantities, horizon_days, totals);
+    return totals;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "batch_pricer.hpp"
+#include "huge_page_allocator.hpp"
+#include "span.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/// Calendar days per year used to turn horizon days into elapsed years (matches theta).
+constexpr double DAYS_PER_YEAR = 365.0;
+
+/// Contract values at a ladder of future dates: row-major contracts × horizons.
+struct DecayLadder {
+    std::size_t contracts = 0;
+    std::size_t horizons  = 0;
+    Column<double> values; ///< values[i * horizons + j]: contract i at horizon j
+
+    double at(std::size_t contract, std::size_t horizon) const {
+        return values[contract * horizons + horizon];
+    }
+};
+
+/// Value every contract of `batch` at each horizon (calendar days from today) with spot,
+/// rate and vol held fixed: contract i at horizon j is priced with T_i - days_j / 365.
+/// Per-contract invariants (ln(S/K), r + σ²/2, payoff sign) are computed once and the
+/// inner loop runs over the contiguous horizon axis. Rows past expiry at a horizon get
+/// their intrinsic value (see price_option_guarded). Never allocates.
+/// Throws std::invalid_argument if values.size() != batch.size() * horizon_days.size().
+void project_time_decay(const ContractBatch& batch, Span<const double> horizon_days,
+                        Span<double> values);
+
+/// Book value at each horizon: totals[j] = Σ_i quantities[i] · value(i, j), accumulated in
+/// row order without materialising the contracts × horizons matrix. Never allocates.
+/// Throws std::invalid_argument if quantities.size() != batch.size() or
+/// totals.size() != horizon_days.size().
+void project_book_decay(const ContractBatch& batch, Span<const double> quantities,
+                        Span<const double> horizon_days, Span<double> totals);
+
+/// Allocating convenience forms of the above.
+DecayLadder project_time_decay(const ContractBatch& batch,
+                               const std::vector<double>& horizon_days);
+std::vector<double> project_book_decay(const ContractBatch& batch,
+                                       const std::vector<double>& quantities,
+                                       const std::vector<double>& horizon_days);
@@ -0,0 +1,113 @@
+#include "reduction.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::size_t PAIRWISE_LEAF = 8; ///< Below this, add sequentially
+
+/// Pairwise sum of term(begin..end). The split points depend only on the range, so the
+/// rounding sequence is fixed for a given block.
+template <typename Term> double pairwise(const Term& term, std::size_t begin, std::size_t end) {
+    const std::size_t n = end - begin;
+    if (n <= PAIRWISE_LEAF) {
+        double s = 0.0;
+        for (std::size_t i = begin; i < end; ++i) {
+            s += term(i);
+        }
+        return s;
+    }
+    const std::size_t mid = begin + n / 2;
+    return pairwise(term, begin, mid) + pairwise(term, mid, end);
+}
+
+/// Sum `lanes` independent series of n terms each. term(lane, i) gives the i-th term of
+/// a lane. Blocks may run on any thread; partials are then combined in a fixed tree.
+template <std::size_t Lanes, typename Term>
+void blocked_sum(const Term& term, std::size_t n, ThreadPool* pool,
+                 std::vector<double>& partials, double (&out)[Lanes]) {
+    const std::size_t blocks = (n + REDUCTION_BLOCK - 1) / REDUCTION_BLOCK;
+    partials.resize(blocks * Lanes);
+
+    const auto sum_block = [&](std::size_t b) {
+        const std::size_t begin = b * REDUCTION_BLOCK;
+        const std::size_t end   = std::min(n, begin + REDUCTION_BLOCK);
+        for (std::size_t lane = 0; lane < Lanes; ++lane) {
+            partials[lane * blocks + b] =
+                pairwise([&](std::size_t i) { return term(lane, i); }, begin, end);
+        }
+    };
+
+    if (pool != nullptr) {
+        pool->parallel_for(blocks, sum_block);
+    } else {
+        for (std::size_t b = 0; b < blocks; ++b) {
+            sum_block(b);
+        }
+    }
+
+    for (std::size_t lane = 0; lane < Lanes; ++lane) {
+        const double* p = &partials[lane * blocks];
+        out[lane]       = pairwise([p](std::size_t b) { return p[b]; }, 0, blocks);
+    }
+}
+
+} // namespace
+
+double deterministic_sum(Span<const double> values, PricingWorkspace& ws, ThreadPool* pool) {
+    const double* v = values.data();
+    double out[1];
+    blocked_sum([v](std::size_t, std::size_t i) { return v[i]; }, values.size(), pool,
+                ws.partials, out);
+    return out[0];
+}
+
+double deterministic_dot(Span<const double> weights, Span<const double> values,
+                         PricingWorkspace& ws, ThreadPool* pool) {
+    if (weights.size() != values.size()) {
+        throw std::invalid_argument("deterministic_dot: weights and values differ in length");
+    }
+    const double* w = weights.data();
+    const double* v = values.data();
+    double out[1];
+    blocked_sum([w, v](std::size_t, std::size_t i) { return w[i] * v[i]; }, values.size(), pool,
+                ws.partials, out);
+    return out[0];
+}
+
+Valuation deterministic_totals(Span<const double> quantities, Span<const Valuation> values,
+                               PricingWorkspace& ws, ThreadPool* pool) {
+    if (quantities.size() != values.size()) {
+        throw std::invalid_argument("deterministic_totals: quantities and values differ in length");
+    }
+
+    const auto term = [&](std::size_t lane, std::size_t i) {
+        const Valuation& v    = values[i];
+        const double field[5] = {v.price, v.greeks.delta, v.greeks.gamma, v.greeks.vega,
+                                 v.greeks.theta};
+        return quantities[i] * field[lane];
+    };
+
+    double out[5];
+    blocked_sum(term, values.size(), pool, ws.partials, out);
+    return Valuation{out[0], Greeks{out[1], out[2], out[3], out[4]}};
+}
+
+double deterministic_sum(const double* values, std::size_t n, ThreadPool* pool) {
+    PricingWorkspace ws;
+    return deterministic_sum(Span<const double>(values, n), ws, pool);
+}
+
+double deterministic_dot(const double* weights, const double* values, std::size_t n,
+                         ThreadPool* pool) {
+    PricingWorkspace ws;
+    return deterministic_dot(Span<const double>(weights, n), Span<const double>(values, n), ws,
+                             pool);
+}
+
+Valuation deterministic_totals(const std::vector<double>& quantities,
+                               const std::vector<Valuation>& values, ThreadPool* pool) {
+    PricingWorkspace ws;
+    return deterministic_totals(quantities, values, ws, pool);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "black_scholes.hpp"
+#include "span.hpp"
+#include "thread_pool.hpp"
+#include "workspace.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/// Elements per reduction block. The block layout depends only on n, never on the
+/// thread count, which is what makes the results reproducible.
+constexpr std::size_t REDUCTION_BLOCK = 4096;
+
+/// Sum of values[0..n) that is bit-identical for any pool size (or no pool).
+/// Each fixed block is summed pairwise, then block partials are combined pairwise in
+/// index order. Pairwise summation also keeps the error at O(log n) ulps rather than
+/// the O(n) of a running sum.
+double deterministic_sum(const double* values, std::size_t n, ThreadPool* pool = nullptr);
+
+/// Σ weights[i]·values[i] with the same reproducibility guarantee as deterministic_sum.
+double deterministic_dot(const double* weights, const double* values, std::size_t n,
+                         ThreadPool* pool = nullptr);
+
+/// Quantity-weighted portfolio totals of price and every Greek, reproducible across
+/// pool sizes. `quantities` and `values` must have the same length.
+Valuation deterministic_totals(const std::vector<double>& quantities,
+                               const std::vector<Valuation>& values, ThreadPool* pool = nullptr);
+
+/// Workspace forms of the reductions above: block partials live in ws.partials, so
+/// these are allocation-free once `ws` is warm. Results are identical to the
+/// allocating forms.
+double deterministic_sum(Span<const double> values, PricingWorkspace& ws,
+                         ThreadPool* pool = nullptr);
+double deterministic_dot(Span<const double> weights, Span<const double> values,
+                         PricingWorkspace& ws, ThreadPool* pool = nullptr);
+Valuation deterministic_totals(Span<const double> quantities, Span<const Valuation> values,
+                               PricingWorkspace& ws, ThreadPool* pool = nullptr);
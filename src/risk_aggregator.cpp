@@ -0,0 +1,119 @@
+#include "risk_aggregator.hpp"
+
+#include <stdexcept>
+
+namespace {
+
+Valuation scaled(const Valuation& v, double q) {
+    return Valuation{q * v.price,
+                     Greeks{q * v.greeks.delta, q * v.greeks.gamma, q * v.greeks.vega,
+                            q * v.greeks.theta}};
+}
+
+/// acc += sign * v
+void accumulate(Valuation& acc, const Valuation& v, double sign) {
+    acc.price += sign * v.price;
+    acc.greeks.delta += sign * v.greeks.delta;
+    acc.greeks.gamma += sign * v.greeks.gamma;
+    acc.greeks.vega += sign * v.greeks.vega;
+    acc.greeks.theta += sign * v.greeks.theta;
+}
+
+} // namespace
+
+RiskAggregator::RiskAggregator(std::size_t resum_interval)
+    : resum_interval_(resum_interval == 0 ? 1 : resum_interval) {}
+
+RiskAggregator::UnderlyingId RiskAggregator::add_underlying(double spot) {
+    underlyings_.push_back(Underlying{spot, {}, Valuation{}, 0});
+    return underlyings_.size() - 1;
+}
+
+RiskAggregator::TradeId RiskAggregator::add_trade(UnderlyingId underlying, double quantity,
+                                                  double K, double r, double sigma, double T,
+                                                  OptionType type) {
+    Underlying& u = underlying_at(underlying);
+
+    Trade t{};
+    t.prepared     = prepare_contract(K, r, sigma, T, type);
+    t.quantity     = quantity;
+    t.underlying   = underlying;
+    t.slot         = u.trades.size();
+    t.contribution = scaled(value_prepared(t.prepared, u.spot), quantity);
+    t.live         = true;
+
+    const TradeId id = trades_.size();
+    trades_.push_back(t);
+    u.trades.push_back(id);
+
+    accumulate(u.totals, t.contribution, +1.0);
+    note_incremental_update(u);
+    return id;
+}
+
+void RiskAggregator::remove_trade(TradeId trade) {
+    if (trade >= trades_.size() || !trades_[trade].live) {
+        throw std::out_of_range("RiskAggregator::remove_trade: unknown trade id");
+    }
+    Trade& t      = trades_[trade];
+    Underlying& u = underlyings_[t.underlying];
+
+    // Swap-remove from the underlying's trade list.
+    const TradeId last = u.trades.back();
+    u.trades[t.slot]   = last;
+    trades_[last].slot = t.slot;
+    u.trades.pop_back();
+    t.live = false;
+
+    accumulate(u.totals, t.contribution, -1.0);
+    note_incremental_update(u);
+}
+
+void RiskAggregator::move_spot(UnderlyingId underlying, double spot) {
+    Underlying& u = underlying_at(underlying);
+    u.spot        = spot;
+    for (const TradeId id : u.trades) {
+        Trade& t       = trades_[id];
+        t.contribution = scaled(value_prepared(t.prepared, spot), t.quantity);
+    }
+    resum(u); // every contribution changed, so summing afresh costs the same as patching
+}
+
+const Valuation& RiskAggregator::totals(UnderlyingId underlying) const {
+    return underlyings_.at(underlying).totals;
+}
+
+double RiskAggregator::spot(UnderlyingId underlying) const {
+    return underlyings_.at(underlying).spot;
+}
+
+std::size_t RiskAggregator::trade_count(UnderlyingId underlying) const {
+    return underlyings_.at(underlying).trades.size();
+}
+
+void RiskAggregator::resum_all() {
+    for (Underlying& u : underlyings_) {
+        resum(u);
+    }
+}
+
+RiskAggregator::Underlying& RiskAggregator::underlying_at(UnderlyingId id) {
+    if (id >= underlyings_.size()) {
+        throw std::out_of_range("RiskAggregator: unknown underlying id");
+    }
+    return underlyings_[id];
+}
+
+void RiskAggregator::note_incremental_update(Underlying& u) {
+    if (++u.updates_since_resum >= resum_interval_) {
+        resum(u);
+    }
+}
+
+void RiskAggregator::resum(Underlying& u) {
+    u.totals = Valuation{};
+    for (const TradeId id : u.trades) {
+        accumulate(u.totals, trades_[id].contribution, +1.0);
+    }
+    u.updates_since_resum = 0;
+}
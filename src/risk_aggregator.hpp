@@ -0,0 +1,69 @@
+#pragma once
+
+#include "black_scholes.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/// Running per-underlying totals of position-weighted price and Greeks.
+///
+/// Each trade keeps its PreparedContract and its current contribution
+/// (quantity × value). Adding or removing a trade adjusts its underlying's totals in
+/// O(1); a spot move re-values only the trades on that underlying from their prepared
+/// state. Incremental add/subtract accumulates rounding drift, so after
+/// `resum_interval` incremental updates an underlying's totals are re-summed from the
+/// stored contributions.
+class RiskAggregator {
+  public:
+    using UnderlyingId = std::size_t;
+    using TradeId      = std::size_t;
+
+    explicit RiskAggregator(std::size_t resum_interval = 1024);
+
+    UnderlyingId add_underlying(double spot);
+
+    /// Book a trade of `quantity` contracts (negative = short). O(1).
+    TradeId add_trade(UnderlyingId underlying, double quantity, double K, double r, double sigma,
+                      double T, OptionType type);
+
+    /// Remove a previously booked trade. O(1). Throws std::out_of_range on unknown ids.
+    void remove_trade(TradeId trade);
+
+    /// Move an underlying's spot and re-value its trades. O(trades on that underlying).
+    void move_spot(UnderlyingId underlying, double spot);
+
+    /// Current totals for one underlying.
+    const Valuation& totals(UnderlyingId underlying) const;
+
+    double spot(UnderlyingId underlying) const;
+
+    std::size_t trade_count(UnderlyingId underlying) const;
+
+    /// Re-sum every underlying's totals from the stored per-trade contributions.
+    void resum_all();
+
+  private:
+    struct Trade {
+        PreparedContract prepared;
+        double quantity;
+        UnderlyingId underlying;
+        std::size_t slot; ///< Position in the underlying's trade list (for O(1) removal)
+        Valuation contribution;
+        bool live;
+    };
+
+    struct Underlying {
+        double spot;
+        std::vector<TradeId> trades;
+        Valuation totals;
+        std::size_t updates_since_resum;
+    };
+
+    Underlying& underlying_at(UnderlyingId id);
+    void note_incremental_update(Underlying& u);
+    void resum(Underlying& u);
+
+    std::size_t resum_interval_;
+    std::vector<Trade> trades_;
+    std::vector<Underlying> underlyings_;
+};
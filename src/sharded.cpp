@@ -0,0 +1,576 @@
+#include "sharded.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+using Clock     = std::chrono::steady_clock;
+using TimePoint = Clock::time_point;
+
+constexpr TimePoint NO_DEADLINE = TimePoint::max();
+
+constexpr std::uint64_t SHARD_MAGIC = 0x3144524148535850; // "PXSHARD1" little-endian
+
+struct RequestHeader {
+    std::uint64_t magic;
+    std::uint64_t shard;
+    std::uint64_t rows;
+};
+
+struct ReplyHeader {
+    std::uint64_t magic;
+    std::uint64_t shard;
+    std::uint64_t rows;
+};
+
+/// Control messages between the coordinator and its spawner process.
+enum SpawnerOp : std::int32_t { SPAWN_WORKER = 1, KILL_WORKER = 2 };
+
+struct SpawnerRequest {
+    std::int32_t op;
+    std::int32_t fail_after;  ///< SPAWN_WORKER: testing hooks, -1 = off
+    std::int32_t stall_after;
+    std::int32_t pid;         ///< KILL_WORKER: worker to kill and reap
+};
+
+/// Sent with the coordinator's end of the new worker's socket attached (SCM_RIGHTS).
+struct SpawnerReply {
+    std::int32_t pid; ///< New or reaped worker; -1 if the request failed
+};
+
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL; // a dead peer returns EPIPE instead of SIGPIPE
+#else
+constexpr int SEND_FLAGS = 0;
+#endif
+
+/// Unix stream socketpair whose ends are not inherited across exec.
+bool make_socketpair(int fds[2]) {
+#ifdef SOCK_CLOEXEC
+    return socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == 0;
+#else
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        return false;
+    }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return true;
+#endif
+}
+
+/// Close every descriptor above stderr except `keep` (a forked child's copies of the
+/// host's files and sockets, which would otherwise keep those open).
+void close_inherited_fds(int keep) {
+#ifdef SYS_close_range
+    if ((keep <= 3 || syscall(SYS_close_range, 3u, static_cast<unsigned>(keep - 1), 0u) == 0) &&
+        syscall(SYS_close_range, static_cast<unsigned>(keep + 1), ~0u, 0u) == 0) {
+        return;
+    }
+#endif
+    const long limit = sysconf(_SC_OPEN_MAX);
+    for (int fd = 3; fd < (limit > 0 ? limit : 1024); ++fd) {
+        if (fd != keep) {
+            close(fd);
+        }
+    }
+}
+
+/// Wait until `fd` reports `events` (or an error/hang-up, which the caller's next call
+/// surfaces). False once `deadline` passes or poll fails.
+bool wait_ready(int fd, short events, TimePoint deadline) {
+    while (true) {
+        int timeout = -1;
+        if (deadline != NO_DEADLINE) {
+            const auto left =
+                std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            if (left <= 0) {
+                return false;
+            }
+            timeout = static_cast<int>(std::min<long long>(left, INT_MAX));
+        }
+        pollfd p{fd, events, 0};
+        const int ready = poll(&p, 1, timeout);
+        if (ready > 0) {
+            return true;
+        }
+        if (ready < 0 && errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+/// Send every byte before `deadline`. Non-blocking sends plus POLLOUT, so a peer that
+/// stops reading costs at most the deadline. False if the peer is gone or too slow.
+bool write_all(int fd, const void* data, std::size_t bytes, TimePoint deadline = NO_DEADLINE) {
+    const auto* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        const ssize_t n = send(fd, p, bytes, SEND_FLAGS | MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (!wait_ready(fd, POLLOUT, deadline)) {
+                return false;
+            }
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        bytes -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+/// Receive every byte before `deadline`. False on EOF, error or timeout, i.e. the peer
+/// is gone or too slow.
+bool read_all(int fd, void* data, std::size_t bytes, TimePoint deadline = NO_DEADLINE) {
+    auto* p = static_cast<char*>(data);
+    while (bytes > 0) {
+        const ssize_t n = recv(fd, p, bytes, MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (!wait_ready(fd, POLLIN, deadline)) {
+                return false;
+            }
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        bytes -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+template <typename T> bool write_span(int fd, Span<const T> s, TimePoint deadline) {
+    return write_all(fd, s.data(), s.size() * sizeof(T), deadline);
+}
+
+template <typename T, typename A> bool read_column(int fd, std::vector<T, A>& col, std::size_t n) {
+    col.resize(n);
+    return read_all(fd, col.data(), n * sizeof(T));
+}
+
+/// Send `reply` with descriptor `fd` attached, or alone when fd < 0.
+bool send_reply(int control, const SpawnerReply& reply, int fd) {
+    SpawnerReply copy = reply;
+    iovec iov{&copy, sizeof copy};
+    msghdr msg{};
+    msg.msg_iov    = &iov;
+    msg.msg_iovlen = 1;
+    alignas(cmsghdr) char buffer[CMSG_SPACE(sizeof(int))] = {};
+    if (fd >= 0) {
+        msg.msg_control    = buffer;
+        msg.msg_controllen = sizeof buffer;
+        cmsghdr* c         = CMSG_FIRSTHDR(&msg);
+        c->cmsg_level      = SOL_SOCKET;
+        c->cmsg_type       = SCM_RIGHTS;
+        c->cmsg_len        = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(c), &fd, sizeof(int));
+    }
+    ssize_t n;
+    do {
+        n = sendmsg(control, &msg, SEND_FLAGS);
+    } while (n < 0 && errno == EINTR);
+    return n == static_cast<ssize_t>(sizeof copy);
+}
+
+/// Receive a reply and its attached descriptor (-1 if none), close-on-exec.
+bool receive_reply(int control, SpawnerReply& reply, int& fd) {
+    fd = -1;
+    iovec iov{&reply, sizeof reply};
+    msghdr msg{};
+    msg.msg_iov    = &iov;
+    msg.msg_iovlen = 1;
+    alignas(cmsghdr) char buffer[CMSG_SPACE(sizeof(int))] = {};
+    msg.msg_control    = buffer;
+    msg.msg_controllen = sizeof buffer;
+#ifdef MSG_CMSG_CLOEXEC
+    constexpr int RECV_FLAGS = MSG_CMSG_CLOEXEC;
+#else
+    constexpr int RECV_FLAGS = 0;
+#endif
+    ssize_t n;
+    do {
+        n = recvmsg(control, &msg, RECV_FLAGS);
+    } while (n < 0 && errno == EINTR);
+    for (cmsghdr* c = CMSG_FIRSTHDR(&msg); c != nullptr; c = CMSG_NXTHDR(&msg, c)) {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS) {
+            std::memcpy(&fd, CMSG_DATA(c), sizeof(int));
+        }
+    }
+    if (n != static_cast<ssize_t>(sizeof reply)) {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+        return false;
+    }
+    return true;
+}
+
+/// Worker process body: price shards until the coordinator closes the socket.
+/// `fail_after` >= 0 makes the worker exit without replying after that many shards;
+/// `stall_after` >= 0 makes it stop reading instead.
+[[noreturn]] void worker_main(int fd, int fail_after, int stall_after) {
+    ContractBatch batch;
+    Column<double> prices;
+    int served = 0;
+    while (true) {
+        if (stall_after >= 0 && served == stall_after) {
+            while (true) {
+                pause(); // until the coordinator kills us
+            }
+        }
+        RequestHeader req{};
+        if (!read_all(fd, &req, sizeof req) || req.magic != SHARD_MAGIC) {
+            _exit(0);
+        }
+        const std::size_t n = req.rows;
+        if (!read_column(fd, batch.S, n) || !read_column(fd, batch.K, n) ||
+            !read_column(fd, batch.r, n) || !read_column(fd, batch.sigma, n) ||
+            !read_column(fd, batch.T, n) || !read_column(fd, batch.option_type, n)) {
+            _exit(0);
+        }
+        if (fail_after >= 0 && served == fail_after) {
+            _exit(1);
+        }
+        prices.resize(n);
+        ::price_batch(batch, prices);
+
+        const ReplyHeader reply{SHARD_MAGIC, req.shard, req.rows};
+        if (!write_all(fd, &reply, sizeof reply) ||
+            !write_all(fd, prices.data(), n * sizeof(double))) {
+            _exit(0);
+        }
+        ++served;
+    }
+}
+
+/// Spawner process body. Single-threaded, so forking workers from it is safe whatever
+/// the host's threads were doing. Serves SPAWN_WORKER / KILL_WORKER requests until the
+/// coordinator closes the control socket, then waits for the remaining workers, which
+/// exit once the coordinator has closed their sockets too.
+[[noreturn]] void spawner_main(int control) {
+    close_inherited_fds(control);
+    while (true) {
+        SpawnerRequest req{};
+        if (!read_all(control, &req, sizeof req)) {
+            break;
+        }
+        SpawnerReply reply{-1};
+        int fds[2] = {-1, -1};
+        if (req.op == SPAWN_WORKER && make_socketpair(fds)) {
+            const pid_t pid = fork();
+            if (pid == 0) {
+                close(control);
+                close(fds[0]);
+                worker_main(fds[1], req.fail_after, req.stall_after);
+            }
+            close(fds[1]);
+            if (pid < 0) {
+                close(fds[0]);
+                fds[0] = -1;
+            }
+            reply.pid = pid;
+        } else if (req.op == KILL_WORKER && req.pid > 0) {
+            // Our own unreaped child, so the pid cannot have been reused.
+            kill(req.pid, SIGKILL);
+            waitpid(req.pid, nullptr, 0);
+            reply.pid = req.pid;
+        }
+        const bool sent = send_reply(control, reply, fds[0]);
+        if (fds[0] >= 0) {
+            close(fds[0]);
+        }
+        if (!sent) {
+            break;
+        }
+    }
+    while (waitpid(-1, nullptr, 0) > 0 || errno == EINTR) {
+    }
+    _exit(0);
+}
+
+} // namespace
+
+ShardCoordinator::ShardCoordinator(const ShardOptions& options) : options_(options) {
+    if (options_.workers == 0) {
+        options_.workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (options_.shard_rows == 0 || options_.max_attempts < 1) {
+        throw std::invalid_argument("ShardCoordinator: shard_rows and max_attempts must be > 0");
+    }
+    start_spawner();
+    workers_.resize(options_.workers);
+    try {
+        for (std::size_t slot = 0; slot < workers_.size(); ++slot) {
+            spawn(slot, slot == 0);
+        }
+    } catch (...) {
+        shutdown();
+        throw;
+    }
+}
+
+ShardCoordinator::~ShardCoordinator() { shutdown(); }
+
+void ShardCoordinator::start_spawner() {
+    int fds[2];
+    if (!make_socketpair(fds)) {
+        throw std::runtime_error("ShardCoordinator: socketpair failed");
+    }
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        throw std::runtime_error("ShardCoordinator: fork failed");
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        spawner_main(fds[1]);
+    }
+    close(fds[1]);
+    spawner_pid_ = pid;
+    spawner_fd_  = fds[0];
+}
+
+void ShardCoordinator::shutdown() {
+    // Closing the sockets first lets every worker see EOF and exit in parallel; the
+    // spawner then sees EOF on its control socket, reaps them and exits.
+    for (Worker& w : workers_) {
+        if (w.fd >= 0) {
+            close(w.fd);
+        }
+        w = Worker{};
+    }
+    if (spawner_fd_ >= 0) {
+        close(spawner_fd_);
+        spawner_fd_ = -1;
+    }
+    if (spawner_pid_ > 0) {
+        waitpid(spawner_pid_, nullptr, 0);
+        spawner_pid_ = -1;
+    }
+}
+
+void ShardCoordinator::spawn(std::size_t slot, bool test_hooks) {
+    const SpawnerRequest req{SPAWN_WORKER, test_hooks ? options_.fail_after_shards : -1,
+                             test_hooks ? options_.stall_after_shards : -1, 0};
+    SpawnerReply reply{-1};
+    int fd = -1;
+    if (!write_all(spawner_fd_, &req, sizeof req) || !receive_reply(spawner_fd_, reply, fd) ||
+        reply.pid <= 0 || fd < 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        throw std::runtime_error("ShardCoordinator: could not start a worker");
+    }
+    Worker& w = workers_[slot];
+    w.pid     = reply.pid;
+    w.fd      = fd;
+    w.busy    = false;
+}
+
+void ShardCoordinator::retire(std::size_t slot) {
+    Worker& w = workers_[slot];
+    if (w.pid > 0) {
+        // The spawner is the worker's parent, so it kills and reaps it.
+        const SpawnerRequest req{KILL_WORKER, -1, -1, static_cast<std::int32_t>(w.pid)};
+        SpawnerReply reply{-1};
+        int fd = -1;
+        if (write_all(spawner_fd_, &req, sizeof req)) {
+            receive_reply(spawner_fd_, reply, fd);
+        }
+    }
+    if (w.fd >= 0) {
+        close(w.fd);
+    }
+    w = Worker{};
+}
+
+bool ShardCoordinator::respawn(std::size_t slot) {
+    retire(slot);
+    try {
+        spawn(slot, false);
+    } catch (const std::exception&) {
+        return false; // the slot stays empty and is refilled before its next dispatch
+    }
+    ++stats_.respawns;
+    return true;
+}
+
+ShardCoordinator::Clock::time_point ShardCoordinator::deadline(const Worker& w) const {
+    return options_.shard_timeout_ms > 0
+               ? w.dispatched + std::chrono::milliseconds(options_.shard_timeout_ms)
+               : NO_DEADLINE;
+}
+
+bool ShardCoordinator::dispatch(Worker& w, const BatchView& batch, std::size_t shard) {
+    const std::size_t begin = shard * options_.shard_rows;
+    const std::size_t rows  = std::min(options_.shard_rows, batch.size() - begin);
+    const BatchView part    = batch.slice(begin, rows);
+
+    const RequestHeader req{SHARD_MAGIC, shard, rows};
+    w.busy            = true;
+    w.shard           = shard;
+    w.dispatched      = Clock::now();
+    const TimePoint d = deadline(w);
+    return write_all(w.fd, &req, sizeof req, d) && write_span(w.fd, part.S, d) &&
+           write_span(w.fd, part.K, d) && write_span(w.fd, part.r, d) &&
+           write_span(w.fd, part.sigma, d) && write_span(w.fd, part.T, d) &&
+           write_span(w.fd, part.option_type, d);
+}
+
+bool ShardCoordinator::collect(Worker& w, Span<double> prices, std::size_t shards) {
+    const TimePoint d = deadline(w);
+    ReplyHeader reply{};
+    if (!read_all(w.fd, &reply, sizeof reply, d) || reply.magic != SHARD_MAGIC ||
+        reply.shard != w.shard || reply.shard >= shards) {
+        return false;
+    }
+    const std::size_t begin = reply.shard * options_.shard_rows;
+    const std::size_t rows  = std::min(options_.shard_rows, prices.size() - begin);
+    if (reply.rows != rows) {
+        return false;
+    }
+    // Straight into the caller's span: each shard owns its rows, so order is preserved.
+    if (!read_all(w.fd, prices.data() + begin, rows * sizeof(double), d)) {
+        return false;
+    }
+    w.busy = false;
+    return true;
+}
+
+void ShardCoordinator::price_batch(const BatchView& batch, Span<double> prices) {
+    const std::size_t n = batch.size();
+    if (prices.size() != n) {
+        throw std::invalid_argument("ShardCoordinator::price_batch: output span length " +
+                                    std::to_string(prices.size()) + " != batch size " +
+                                    std::to_string(n));
+    }
+    const std::size_t shards = (n + options_.shard_rows - 1) / options_.shard_rows;
+    std::deque<std::size_t> pending;
+    for (std::size_t s = 0; s < shards; ++s) {
+        pending.push_back(s);
+    }
+    std::vector<int> attempts(shards, 0);
+    std::size_t done = 0;
+
+    // A failed worker is replaced at once; its shard is retried up to max_attempts times.
+    const auto fail = [&](std::size_t slot) {
+        Worker& w = workers_[slot];
+        ++stats_.worker_failures;
+        if (w.busy) {
+            const std::size_t shard = w.shard;
+            if (attempts[shard] >= options_.max_attempts) {
+                // The shard's failure is the error to report, not a failed replacement.
+                respawn(slot);
+                throw std::runtime_error("ShardCoordinator: shard " + std::to_string(shard) +
+                                         " failed " + std::to_string(attempts[shard]) +
+                                         " times");
+            }
+            pending.push_front(shard);
+            ++stats_.reassigned;
+        }
+        retire(slot);
+        spawn(slot, false);
+        ++stats_.respawns;
+    };
+
+    std::vector<pollfd> fds;
+    std::vector<std::size_t> slots;
+    try {
+        while (done < shards) {
+            for (std::size_t slot = 0; slot < workers_.size() && !pending.empty(); ++slot) {
+                if (workers_[slot].busy) {
+                    continue;
+                }
+                if (workers_[slot].fd < 0) { // a best-effort respawn failed earlier
+                    spawn(slot, false);
+                    ++stats_.respawns;
+                }
+                const std::size_t shard = pending.front();
+                pending.pop_front();
+                ++attempts[shard];
+                if (!dispatch(workers_[slot], batch, shard)) {
+                    fail(slot);
+                }
+            }
+
+            fds.clear();
+            slots.clear();
+            int timeout = -1;
+            const auto now = Clock::now();
+            for (std::size_t slot = 0; slot < workers_.size(); ++slot) {
+                const Worker& w = workers_[slot];
+                if (!w.busy) {
+                    continue;
+                }
+                fds.push_back(pollfd{w.fd, POLLIN, 0});
+                slots.push_back(slot);
+                if (options_.shard_timeout_ms > 0) {
+                    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                             now - w.dispatched)
+                                             .count();
+                    const int left =
+                        std::max(0, options_.shard_timeout_ms - static_cast<int>(elapsed));
+                    timeout = timeout < 0 ? left : std::min(timeout, left);
+                }
+            }
+            if (fds.empty()) {
+                continue; // every dispatch failed; the retries are queued again
+            }
+
+            if (poll(fds.data(), fds.size(), timeout) < 0 && errno != EINTR) {
+                throw std::runtime_error("ShardCoordinator: poll failed");
+            }
+            for (std::size_t i = 0; i < fds.size(); ++i) {
+                const std::size_t slot = slots[i];
+                if (fds[i].revents != 0) {
+                    if (collect(workers_[slot], prices, shards)) {
+                        ++done;
+                        ++stats_.shards;
+                    } else {
+                        fail(slot);
+                    }
+                } else if (options_.shard_timeout_ms > 0 &&
+                           Clock::now() - workers_[slot].dispatched >=
+                               std::chrono::milliseconds(options_.shard_timeout_ms)) {
+                    fail(slot);
+                }
+            }
+        }
+    } catch (...) {
+        // Busy workers still owe replies for this batch; replace them so the next batch
+        // starts from a clean protocol state. Best effort, so the error rethrown is the
+        // one that ended the batch.
+        for (std::size_t slot = 0; slot < workers_.size(); ++slot) {
+            if (workers_[slot].busy) {
+                respawn(slot);
+            }
+        }
+        throw;
+    }
+    ++stats_.batches;
+}
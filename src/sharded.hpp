@@ -0,0 +1,100 @@
+#pragma once
+
+#include "batch_pricer.hpp"
+#include "span.hpp"
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Configuration of a ShardCoordinator.
+struct ShardOptions {
+    unsigned workers       = 0;       ///< Worker processes; 0 = hardware_concurrency()
+    std::size_t shard_rows = 1 << 16; ///< Rows per shard (the unit of dispatch and retry)
+    int max_attempts       = 3;       ///< Dispatches per shard before the batch fails
+    int shard_timeout_ms   = 0;       ///< Replace a worker stuck this long on a shard; 0 = off
+
+    /// Testing hooks for the first worker, to exercise failover; -1 disables them. After
+    /// serving this many shards it exits without replying (fail) or stops reading its
+    /// socket, as if hung, so the coordinator's writes back up (stall).
+    int fail_after_shards  = -1;
+    int stall_after_shards = -1;
+};
+
+/// Counters accumulated over a coordinator's lifetime.
+struct ShardStats {
+    std::uint64_t batches         = 0;
+    std::uint64_t shards          = 0; ///< Shards completed
+    std::uint64_t reassigned      = 0; ///< Shards re-dispatched after a worker failure
+    std::uint64_t worker_failures = 0; ///< Workers that died, hung or broke protocol
+    std::uint64_t respawns        = 0; ///< Replacement workers started
+};
+
+/// Coordinator/worker pricing across local processes.
+///
+/// The constructor forks one single-threaded spawner process, and every worker (the
+/// initial ones and later replacements) is forked by the spawner and handed back over a
+/// control socket. The host is therefore forked exactly once, at construction: create
+/// coordinators before starting threads, as a fork of a multi-threaded process may
+/// inherit locks (malloc's, stdio's) held by threads that do not exist in the child.
+/// Sockets are created close-on-exec, and the spawner closes every descriptor it
+/// inherited, so workers hold nothing but their own socket.
+///
+/// Each worker talks to the coordinator over a Unix stream socket (socketpair).
+/// price_batch cuts the batch into fixed shards and keeps every worker busy with one
+/// shard at a time: a request carries the shard's rows as raw columns, the reply its
+/// prices, which land directly in the caller's span, so results merge in row order
+/// regardless of completion order. With shard_timeout_ms set, sending a shard and
+/// reading its reply share one deadline, so a worker that stops reading cannot block
+/// the coordinator. A worker that closes its socket, breaks the protocol or overruns
+/// shard_timeout_ms is killed and replaced, and its shard goes back on the queue; a
+/// shard that fails max_attempts times fails the batch.
+///
+/// The wire format is position independent (no pointers, rows sent by value), so the
+/// same framing can run over TCP between hosts; it uses native byte order, like the
+/// snapshot files. Not thread-safe: one price_batch at a time per coordinator.
+class ShardCoordinator {
+  public:
+    explicit ShardCoordinator(const ShardOptions& options = {});
+    ~ShardCoordinator();
+
+    ShardCoordinator(const ShardCoordinator&)            = delete;
+    ShardCoordinator& operator=(const ShardCoordinator&) = delete;
+
+    /// Price `batch` into `prices` (row order) on the worker processes.
+    /// Throws std::invalid_argument on a length mismatch and std::runtime_error if a
+    /// shard keeps failing or no worker can be started.
+    void price_batch(const BatchView& batch, Span<double> prices);
+
+    unsigned workers() const { return static_cast<unsigned>(workers_.size()); }
+    const ShardStats& stats() const { return stats_; }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Worker {
+        pid_t pid         = -1;
+        int fd            = -1; ///< Coordinator's end of the socketpair
+        bool busy         = false;
+        std::size_t shard = 0;
+        Clock::time_point dispatched{};
+    };
+
+    void start_spawner();
+    void shutdown();                              ///< Close every socket, reap the spawner
+    void spawn(std::size_t slot, bool test_hooks); ///< Ask the spawner for a worker
+    void retire(std::size_t slot);                ///< Kill (if alive), close and reap
+    bool respawn(std::size_t slot);               ///< Best-effort retire + spawn
+    bool dispatch(Worker& w, const BatchView& batch, std::size_t shard);
+    bool collect(Worker& w, Span<double> prices, std::size_t shards);
+    Clock::time_point deadline(const Worker& w) const; ///< End of w's current shard
+
+    ShardOptions options_;
+    pid_t spawner_pid_ = -1;
+    int spawner_fd_    = -1; ///< Coordinator's end of the spawner's control socket
+    std::vector<Worker> workers_;
+    ShardStats stats_{};
+};
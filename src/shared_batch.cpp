@@ -0,0 +1,203 @@
+#include "shared_batch.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+constexpr char SHARED_MAGIC[8]         = {'O', 'P', 'X', 'S', 'H', 'M', 'B', '1'};
+constexpr std::uint32_t SHARED_VERSION = 1;
+constexpr std::size_t COLUMN_ALIGN     = 64;
+
+struct alignas(COLUMN_ALIGN) SharedHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t rows;
+};
+
+inline std::size_t round_up(std::size_t n, std::size_t multiple) {
+    return (n + multiple - 1) / multiple * multiple;
+}
+
+std::runtime_error shm_error(const char* fn, const std::string& name) {
+    return std::runtime_error(std::string(fn) + ": " + name + ": " + std::strerror(errno));
+}
+
+/// Closes the descriptor once the mapping exists; the mapping keeps the segment alive.
+struct FdGuard {
+    int fd;
+    ~FdGuard() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+};
+
+void check_rows(std::size_t rows, std::size_t begin, std::size_t end, const char* fn) {
+    if (begin > end || end > rows) {
+        throw std::out_of_range(std::string(fn) + ": rows [" + std::to_string(begin) + ", " +
+                                std::to_string(end) + ") exceed size " + std::to_string(rows));
+    }
+}
+
+} // namespace
+
+std::size_t SharedBatch::column_offset(std::size_t rows, Col c) {
+    static constexpr std::size_t widths[] = {
+        sizeof(double), sizeof(double),     sizeof(double), sizeof(double),
+        sizeof(double), sizeof(OptionType), sizeof(double), sizeof(Greeks),
+    };
+    static_assert(sizeof widths / sizeof widths[0] == static_cast<std::size_t>(Col::COUNT),
+                  "one width per column");
+
+    std::size_t offset = sizeof(SharedHeader);
+    for (std::size_t i = 0; i < static_cast<std::size_t>(c); ++i) {
+        offset += round_up(rows * widths[i], COLUMN_ALIGN);
+    }
+    return offset;
+}
+
+std::size_t SharedBatch::segment_bytes(std::size_t rows) {
+    return column_offset(rows, Col::COUNT);
+}
+
+SharedBatch SharedBatch::create(const std::string& name, std::size_t rows) {
+    const std::size_t bytes = segment_bytes(rows);
+
+    FdGuard fd{shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600)};
+    if (fd.fd < 0) {
+        throw shm_error("SharedBatch::create", name);
+    }
+    if (ftruncate(fd.fd, static_cast<off_t>(bytes)) != 0) {
+        const auto err = shm_error("SharedBatch::create", name);
+        shm_unlink(name.c_str());
+        throw err;
+    }
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd.fd, 0);
+    if (p == MAP_FAILED) {
+        const auto err = shm_error("SharedBatch::create", name);
+        shm_unlink(name.c_str());
+        throw err;
+    }
+
+    // ftruncate zero-fills, so only the header needs writing.
+    auto* header = static_cast<SharedHeader*>(p);
+    std::memcpy(header->magic, SHARED_MAGIC, sizeof header->magic);
+    header->version = SHARED_VERSION;
+    header->rows    = rows;
+
+    return SharedBatch(name, rows, static_cast<char*>(p), bytes, true);
+}
+
+SharedBatch SharedBatch::create(const std::string& name, const BatchView& batch) {
+    SharedBatch shared = create(name, batch.size());
+    const std::size_t n = batch.size();
+    if (n > 0) {
+        std::memcpy(shared.S().data(), batch.S.data(), n * sizeof(double));
+        std::memcpy(shared.K().data(), batch.K.data(), n * sizeof(double));
+        std::memcpy(shared.r().data(), batch.r.data(), n * sizeof(double));
+        std::memcpy(shared.sigma().data(), batch.sigma.data(), n * sizeof(double));
+        std::memcpy(shared.T().data(), batch.T.data(), n * sizeof(double));
+        std::memcpy(shared.option_type().data(), batch.option_type.data(),
+                    n * sizeof(OptionType));
+    }
+    return shared;
+}
+
+SharedBatch SharedBatch::attach(const std::string& name) {
+    FdGuard fd{shm_open(name.c_str(), O_RDWR, 0)};
+    if (fd.fd < 0) {
+        throw shm_error("SharedBatch::attach", name);
+    }
+    struct stat st {};
+    if (fstat(fd.fd, &st) != 0) {
+        throw shm_error("SharedBatch::attach", name);
+    }
+    const auto bytes = static_cast<std::size_t>(st.st_size);
+    if (bytes < sizeof(SharedHeader)) {
+        throw std::runtime_error("SharedBatch::attach: " + name + " is not a shared batch");
+    }
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd.fd, 0);
+    if (p == MAP_FAILED) {
+        throw shm_error("SharedBatch::attach", name);
+    }
+
+    const auto* header = static_cast<const SharedHeader*>(p);
+    if (std::memcmp(header->magic, SHARED_MAGIC, sizeof header->magic) != 0 ||
+        header->version != SHARED_VERSION || segment_bytes(header->rows) > bytes) {
+        munmap(p, bytes);
+        throw std::runtime_error("SharedBatch::attach: " + name + " is not a v1 shared batch");
+    }
+    return SharedBatch(name, header->rows, static_cast<char*>(p), bytes, false);
+}
+
+SharedBatch SharedBatch::attach(const SharedBatchHandle& handle) {
+    SharedBatch shared = attach(handle.name);
+    if (shared.size() != handle.rows) {
+        throw std::runtime_error("SharedBatch::attach: " + handle.name + " has " +
+                                 std::to_string(shared.size()) + " rows, handle expects " +
+                                 std::to_string(handle.rows));
+    }
+    return shared;
+}
+
+SharedBatch::SharedBatch(SharedBatch&& other) noexcept
+    : name_(std::move(other.name_)), rows_(other.rows_), base_(other.base_),
+      bytes_(other.bytes_), owner_(other.owner_) {
+    other.base_  = nullptr;
+    other.owner_ = false;
+}
+
+SharedBatch& SharedBatch::operator=(SharedBatch&& other) noexcept {
+    if (this != &other) {
+        release();
+        name_        = std::move(other.name_);
+        rows_        = other.rows_;
+        base_        = other.base_;
+        bytes_       = other.bytes_;
+        owner_       = other.owner_;
+        other.base_  = nullptr;
+        other.owner_ = false;
+    }
+    return *this;
+}
+
+SharedBatch::~SharedBatch() { release(); }
+
+void SharedBatch::release() {
+    if (base_ != nullptr) {
+        munmap(base_, bytes_);
+        base_ = nullptr;
+    }
+    unlink();
+}
+
+void SharedBatch::unlink() {
+    if (owner_) {
+        shm_unlink(name_.c_str());
+        owner_ = false;
+    }
+}
+
+BatchView SharedBatch::view() const {
+    return BatchView(S(), K(), r(), sigma(), T(), option_type());
+}
+
+void SharedBatch::price_rows(std::size_t begin, std::size_t end) const {
+    check_rows(rows_, begin, end, "SharedBatch::price_rows");
+    price_batch(view().slice(begin, end - begin), prices().subspan(begin, end - begin));
+}
+
+void SharedBatch::greeks_rows(std::size_t begin, std::size_t end) const {
+    check_rows(rows_, begin, end, "SharedBatch::greeks_rows");
+    greeks_batch(view().slice(begin, end - begin), greeks().subspan(begin, end - begin));
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "batch_pricer.hpp"
+#include "span.hpp"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+/// Everything another process needs to reattach a SharedBatch: the segment name and the
+/// row count (checked against the segment header on attach). Cheap to copy and pickle.
+struct SharedBatchHandle {
+    std::string name;
+    std::size_t rows;
+};
+
+/// ContractBatch columns plus result buffers (prices, Greeks) in one named POSIX
+/// shared-memory segment, so worker processes can attach by name and price disjoint
+/// row slices in place instead of receiving pickled contracts.
+///
+/// Layout: a 64-byte header, then S, K, r, sigma, T, option_type, prices and greeks, each
+/// starting on a 64-byte boundary; slices of a multiple of 8 rows therefore never share
+/// a cache line of prices. Result buffers cost nothing until written: shm pages are only
+/// backed once touched.
+///
+/// The creating instance owns the name and unlinks it on destruction; attached instances
+/// only unmap. Existing mappings stay valid after the unlink, so workers that attached in
+/// time keep working even if the creator exits first. Native byte order, same host only.
+class SharedBatch {
+  public:
+    /// Create a zero-filled segment of `rows` rows. `name` follows shm_open rules
+    /// ("/name", no further slashes). Throws std::runtime_error if the name exists or the
+    /// segment cannot be created.
+    static SharedBatch create(const std::string& name, std::size_t rows);
+
+    /// Create a segment sized for `batch` and copy its columns in.
+    static SharedBatch create(const std::string& name, const BatchView& batch);
+
+    /// Map an existing segment read-write. Throws std::runtime_error if it does not
+    /// exist, is not a shared batch, or (for the handle form) has a different row count.
+    static SharedBatch attach(const std::string& name);
+    static SharedBatch attach(const SharedBatchHandle& handle);
+
+    SharedBatch(SharedBatch&& other) noexcept;
+    SharedBatch& operator=(SharedBatch&& other) noexcept;
+    ~SharedBatch();
+
+    SharedBatch(const SharedBatch&)            = delete;
+    SharedBatch& operator=(const SharedBatch&) = delete;
+
+    std::size_t size() const { return rows_; }
+    const std::string& name() const { return name_; }
+    SharedBatchHandle handle() const { return {name_, rows_}; }
+
+    /// True for the instance that created (and will unlink) the segment.
+    bool owner() const { return owner_; }
+
+    /// Remove the name now; later attach() calls fail, existing mappings stay valid.
+    /// Idempotent.
+    void unlink();
+
+    Span<double> S() const { return column<double>(Col::S); }
+    Span<double> K() const { return column<double>(Col::K); }
+    Span<double> r() const { return column<double>(Col::R); }
+    Span<double> sigma() const { return column<double>(Col::SIGMA); }
+    Span<double> T() const { return column<double>(Col::T); }
+    Span<OptionType> option_type() const { return column<OptionType>(Col::TYPE); }
+    Span<double> prices() const { return column<double>(Col::PRICES); }
+    Span<Greeks> greeks() const { return column<Greeks>(Col::GREEKS); }
+
+    /// All rows as a view for the batch kernels.
+    BatchView view() const;
+
+    /// price_batch over rows [begin, end) into prices()[begin, end). Workers given
+    /// disjoint ranges write disjoint parts of the result buffer, so no locking is needed.
+    /// Throws std::out_of_range if the range exceeds size().
+    void price_rows(std::size_t begin, std::size_t end) const;
+
+    /// greeks_batch over rows [begin, end) into greeks()[begin, end).
+    void greeks_rows(std::size_t begin, std::size_t end) const;
+
+  private:
+    enum class Col { S, K, R, SIGMA, T, TYPE, PRICES, GREEKS, COUNT };
+
+    SharedBatch(std::string name, std::size_t rows, char* base, std::size_t bytes, bool owner)
+        : name_(std::move(name)), rows_(rows), base_(base), bytes_(bytes), owner_(owner) {}
+
+    template <typename T> Span<T> column(Col c) const {
+        return Span<T>(reinterpret_cast<T*>(base_ + column_offset(rows_, c)), rows_);
+    }
+
+    static std::size_t column_offset(std::size_t rows, Col c);
+    static std::size_t segment_bytes(std::size_t rows);
+    void release();
+
+    std::string name_;
+    std::size_t rows_  = 0;
+    char* base_        = nullptr;
+    std::size_t bytes_ = 0;
+    bool owner_        = false;
+};
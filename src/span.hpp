@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/// Non-owning view of a contiguous array (a minimal C++17 stand-in for std::span).
+/// Batch entry points take their outputs as spans so callers own, size and reuse the
+/// memory; Span<const T> is used for read-only inputs.
+template <typename T> class Span {
+  public:
+    Span() = default;
+    Span(T* data, std::size_t size) : data_(data), size_(size) {}
+
+    template <typename U, typename A,
+              typename = std::enable_if_t<std::is_convertible<U (*)[], T (*)[]>::value>>
+    Span(std::vector<U, A>& v) : data_(v.data()), size_(v.size()) {}
+
+    template <typename U, typename A,
+              typename = std::enable_if_t<std::is_convertible<const U (*)[], T (*)[]>::value>>
+    Span(const std::vector<U, A>& v) : data_(v.data()), size_(v.size()) {}
+
+    /// Span<T> -> Span<const T>
+    template <typename U,
+              typename = std::enable_if_t<std::is_convertible<U (*)[], T (*)[]>::value>>
+    Span(const Span<U>& other) : data_(other.data()), size_(other.size()) {}
+
+    T* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    T& operator[](std::size_t i) const { return data_[i]; }
+    T* begin() const { return data_; }
+    T* end() const { return data_ + size_; }
+
+    /// Elements [offset, offset + count).
+    Span subspan(std::size_t offset, std::size_t count) const {
+        return Span(data_ + offset, count);
+    }
+
+  private:
+    T* data_          = nullptr;
+    std::size_t size_ = 0;
+};
@@ -0,0 +1,74 @@
+#include "strategy.hpp"
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr std::size_t UNPRICED = std::numeric_limits<std::size_t>::max();
+
+} // namespace
+
+LegCounts price_strategies(Span<const Contract> contracts, Span<const Strategy> strategies,
+                           Span<StrategyValue> values, PricingWorkspace& ws) {
+    if (values.size() != strategies.size()) {
+        throw std::invalid_argument("price_strategies: output span length != strategy count");
+    }
+    LegCounts counts{};
+
+    // Pass 1: map each referenced contract id to a slot in the unique-leg batch.
+    std::vector<std::size_t>& slot_of = ws.rows;
+    std::vector<Contract>& unique     = ws.contracts;
+    slot_of.assign(contracts.size(), UNPRICED);
+    unique.clear();
+
+    for (const auto& strategy : strategies) {
+        for (const auto& leg : strategy.legs) {
+            if (leg.contract_id >= contracts.size()) {
+                throw std::out_of_range("price_strategies: leg references unknown contract id " +
+                                        std::to_string(leg.contract_id));
+            }
+            if (slot_of[leg.contract_id] == UNPRICED) {
+                slot_of[leg.contract_id] = unique.size();
+                unique.push_back(contracts[leg.contract_id]);
+            }
+            ++counts.total_legs;
+        }
+    }
+    counts.unique_legs = unique.size();
+
+    // Pass 2: price each distinct leg once.
+    ws.prices.resize(unique.size());
+    ws.greeks.resize(unique.size());
+    price_batch(unique, ws.prices);
+    greeks_batch(unique, ws.greeks);
+
+    // Pass 3: scatter leg results back into signed per-strategy sums.
+    for (std::size_t s = 0; s < strategies.size(); ++s) {
+        StrategyValue v{};
+        for (const auto& leg : strategies[s].legs) {
+            const std::size_t slot = slot_of[leg.contract_id];
+            const Greeks& g        = ws.greeks[slot];
+            v.price += leg.quantity * ws.prices[slot];
+            v.greeks.delta += leg.quantity * g.delta;
+            v.greeks.gamma += leg.quantity * g.gamma;
+            v.greeks.vega += leg.quantity * g.vega;
+            v.greeks.theta += leg.quantity * g.theta;
+        }
+        values[s] = v;
+    }
+
+    return counts;
+}
+
+StrategyBatchResult price_strategies(const std::vector<Contract>& contracts,
+                                     const std::vector<Strategy>& strategies) {
+    PricingWorkspace ws;
+    StrategyBatchResult result{};
+    result.values.resize(strategies.size());
+    const LegCounts counts = price_strategies(contracts, strategies, result.values, ws);
+    result.total_legs      = counts.total_legs;
+    result.unique_legs     = counts.unique_legs;
+    return result;
+}
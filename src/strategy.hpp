@@ -0,0 +1,51 @@
+#pragma once
+
+#include "batch_pricer.hpp"
+#include "workspace.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/// One leg of a multi-leg strategy: a signed position in a shared contract.
+struct Leg {
+    std::size_t contract_id; ///< Index into the contract table passed to the pricer
+    double quantity;         ///< Signed size; positive = long, negative = short
+};
+
+/// A multi-leg option strategy (spread, straddle, condor, butterfly, ...).
+/// Legs reference contracts by id so overlapping strategies share the same contract.
+struct Strategy {
+    std::vector<Leg> legs;
+};
+
+/// Aggregated value and sensitivities of one strategy.
+struct StrategyValue {
+    double price;  ///< Sum of quantity * leg price
+    Greeks greeks; ///< Sum of quantity * leg Greeks
+};
+
+/// Result of pricing a batch of strategies.
+struct StrategyBatchResult {
+    std::vector<StrategyValue> values; ///< One entry per strategy, in input order
+    std::size_t total_legs;            ///< Legs across all strategies
+    std::size_t unique_legs;           ///< Distinct contracts actually priced
+};
+
+/// Leg counts from one price_strategies call.
+struct LegCounts {
+    std::size_t total_legs;  ///< Legs across all strategies
+    std::size_t unique_legs; ///< Distinct contracts actually priced
+};
+
+/// Price a batch of strategies whose legs index into `contracts`, writing values[i] for
+/// strategies[i]. Every contract referenced by at least one leg is priced exactly once
+/// through the batch kernels, then scattered back and aggregated per strategy.
+/// Allocation-free once `ws` is warm.
+/// Throws std::out_of_range if a leg references a contract id outside the table, and
+/// std::invalid_argument if values.size() != strategies.size().
+LegCounts price_strategies(Span<const Contract> contracts, Span<const Strategy> strategies,
+                           Span<StrategyValue> values, PricingWorkspace& ws);
+
+/// Allocating convenience form of price_strategies.
+StrategyBatchResult price_strategies(const std::vector<Contract>& contracts,
+                                     const std::vector<Strategy>& strategies);
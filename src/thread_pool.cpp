@@ -0,0 +1,219 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/// Pauses per poll once the backoff has saturated; about 1-3 µs on current x86 cores.
+constexpr unsigned MAX_BACKOFF = 64;
+
+/// Saturated polls before a spinning thread starts yielding, so an oversubscribed
+/// machine still makes progress.
+constexpr unsigned SPINS_BEFORE_YIELD = 32;
+
+/// Tell the core this is a spin-wait loop (frees pipeline resources for the sibling
+/// hyperthread and avoids the memory-order flush on exit).
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/// Spin until done() holds, with exponential pause backoff and a yield fallback.
+template <typename Done> void spin_until(const Done& done) {
+    unsigned backoff   = 1;
+    unsigned saturated = 0;
+    while (!done()) {
+        for (unsigned i = 0; i < backoff; ++i) {
+            cpu_relax();
+        }
+        if (backoff < MAX_BACKOFF) {
+            backoff *= 2;
+        } else if (++saturated >= SPINS_BEFORE_YIELD) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(unsigned threads) : ThreadPool(PoolOptions{threads}) {}
+
+ThreadPool::ThreadPool(const PoolOptions& options) : wait_(options.wait) {
+    const unsigned cores = std::thread::hardware_concurrency();
+    unsigned threads     = options.threads;
+    if (threads == 0) {
+        threads = cores;
+    }
+    // Oversubscribed spinners burn the time slices of the threads they wait for.
+    if (cores != 0 && threads > cores) {
+        wait_ = PoolWait::BLOCK;
+    }
+    for (unsigned i = 1; i < threads; ++i) { // the caller is thread 0
+        workers_.emplace_back([this] { worker_loop(); });
+        if (options.pin) {
+            pin_worker(workers_.size() - 1, options.first_cpu);
+        }
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_.store(true, std::memory_order_release);
+    }
+    wake_.notify_all();
+    for (auto& w : workers_) {
+        w.join();
+    }
+}
+
+void ThreadPool::pin_worker(std::size_t index, unsigned first_cpu) {
+#ifdef __linux__
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET((first_cpu + index) % cores, &set);
+    // Best effort: a restricted cpuset just leaves the thread unpinned.
+    pthread_setaffinity_np(workers_[index].native_handle(), sizeof set, &set);
+#else
+    (void)index;
+    (void)first_cpu;
+#endif
+}
+
+void ThreadPool::run(std::size_t tasks, TaskRef task) {
+    if (tasks == 0) {
+        return;
+    }
+    if (workers_.empty() || tasks == 1) {
+        for (std::size_t i = 0; i < tasks; ++i) {
+            task.invoke(task.callable, i);
+        }
+        return;
+    }
+
+    // A caller that finds the pool busy runs its tasks itself instead of queueing
+    // behind the current parallel_for, so many callers sharing one pool scale with
+    // their own threads rather than serializing on it.
+    std::unique_lock<std::mutex> submit(submit_mutex_, std::try_to_lock);
+    if (!submit.owns_lock()) {
+        for (std::size_t i = 0; i < tasks; ++i) {
+            task.invoke(task.callable, i);
+        }
+        return;
+    }
+
+    if (wait_ == PoolWait::SPIN) {
+        task_       = task;
+        task_count_ = tasks;
+        next_task_.store(0, std::memory_order_relaxed);
+        failed_.store(false, std::memory_order_relaxed);
+        busy_workers_.store(workers_.size(), std::memory_order_relaxed);
+        generation_.fetch_add(1, std::memory_order_release);
+
+        drain();
+
+        spin_until([this] { return busy_workers_.load(std::memory_order_acquire) == 0; });
+        task_ = TaskRef{};
+        rethrow_task_error();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_       = task;
+        task_count_ = tasks;
+        next_task_.store(0, std::memory_order_relaxed);
+        failed_.store(false, std::memory_order_relaxed);
+        busy_workers_.store(workers_.size(), std::memory_order_relaxed);
+        generation_.fetch_add(1, std::memory_order_relaxed);
+    }
+    wake_.notify_all();
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return busy_workers_.load(std::memory_order_relaxed) == 0; });
+    task_ = TaskRef{};
+    lock.unlock();
+    rethrow_task_error();
+}
+
+void ThreadPool::drain() {
+    for (;;) {
+        const std::size_t i = next_task_.fetch_add(1, std::memory_order_relaxed);
+        if (i >= task_count_) {
+            return;
+        }
+        try {
+            task_.invoke(task_.callable, i);
+        } catch (...) {
+            // Keep the first exception for the caller and hand out no further indices;
+            // tasks already running on other threads still finish.
+            if (!failed_.exchange(true, std::memory_order_relaxed)) {
+                error_ = std::current_exception();
+            }
+            next_task_.store(task_count_, std::memory_order_relaxed);
+        }
+    }
+}
+
+void ThreadPool::rethrow_task_error() {
+    if (error_) {
+        std::exception_ptr error = std::move(error_);
+        error_                   = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::worker_loop() {
+    std::uint64_t seen = 0;
+    for (;;) {
+        if (wait_ == PoolWait::SPIN) {
+            spin_until([&] {
+                return generation_.load(std::memory_order_acquire) != seen ||
+                       stop_.load(std::memory_order_acquire);
+            });
+            if (stop_.load(std::memory_order_acquire)) {
+                return;
+            }
+            seen = generation_.load(std::memory_order_acquire);
+
+            drain();
+
+            busy_workers_.fetch_sub(1, std::memory_order_release);
+            continue;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] {
+                return stop_.load(std::memory_order_relaxed) ||
+                       generation_.load(std::memory_order_relaxed) != seen;
+            });
+            if (stop_.load(std::memory_order_relaxed)) {
+                return;
+            }
+            seen = generation_.load(std::memory_order_relaxed);
+        }
+
+        drain();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (busy_workers_.fetch_sub(1, std::memory_order_relaxed) == 1) {
+            done_.notify_one();
+        }
+    }
+}
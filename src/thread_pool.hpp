@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// How idle pool threads wait for the next parallel_for, and how the caller waits for
+/// them to finish.
+enum class PoolWait {
+    /// Sleep on a condition variable: no CPU while idle, but each parallel_for pays a
+    /// futex wake-up per worker (tens of microseconds), which dominates small batches.
+    BLOCK,
+    /// Busy-poll an atomic generation counter with pause instructions and exponential
+    /// backoff, yielding once the backoff saturates. Wake-up is a cache-line transfer,
+    /// at the cost of burning the workers' cores while idle: use with dedicated cores.
+    /// A pool with more threads than hardware_concurrency() falls back to BLOCK.
+    SPIN,
+};
+
+/// Construction options for ThreadPool.
+struct PoolOptions {
+    unsigned threads   = 0;               ///< Including the caller; 0 = hardware_concurrency()
+    PoolWait wait      = PoolWait::BLOCK;
+    bool pin           = false;           ///< Linux: pin worker i to CPU first_cpu + i
+    unsigned first_cpu = 1;               ///< CPU 0 is left to the caller's thread
+};
+
+/// Fixed-size pool of pricing threads.
+///
+/// parallel_for hands out task indices dynamically, so which thread runs which task
+/// varies from call to call. Anything that must be reproducible (e.g. reductions) has
+/// to fix its own task decomposition and combine order instead of relying on the pool.
+class ThreadPool {
+  public:
+    /// `threads` counts the calling thread, so ThreadPool(1) runs everything inline.
+    /// 0 means std::thread::hardware_concurrency().
+    explicit ThreadPool(unsigned threads = 0);
+    explicit ThreadPool(const PoolOptions& options);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Threads that execute tasks, including the caller.
+    unsigned size() const { return static_cast<unsigned>(workers_.size()) + 1; }
+
+    /// Wait mode in effect (SPIN may have fallen back to BLOCK, see PoolWait).
+    PoolWait wait_mode() const { return wait_; }
+
+    /// Run task(i) for every i in [0, tasks) and block until all have finished.
+    /// If a task throws, no further tasks are started, the ones already running finish,
+    /// and the first exception is rethrown on the calling thread.
+    /// The calling thread works too. If another caller is already using the pool, the
+    /// tasks run inline on the calling thread instead of waiting for it.
+    /// The task is passed by reference, not wrapped in std::function, so dispatch never
+    /// touches the heap.
+    template <typename F> void parallel_for(std::size_t tasks, const F& task) {
+        run(tasks, TaskRef{&task, [](const void* f, std::size_t i) {
+                               (*static_cast<const F*>(f))(i);
+                           }});
+    }
+
+  private:
+    /// Type-erased, non-owning reference to a callable taking a task index.
+    struct TaskRef {
+        const void* callable;
+        void (*invoke)(const void*, std::size_t);
+    };
+
+    void run(std::size_t tasks, TaskRef task);
+    void worker_loop();
+    void drain();
+    void rethrow_task_error();
+    void pin_worker(std::size_t index, unsigned first_cpu);
+
+    PoolWait wait_ = PoolWait::BLOCK;
+    std::vector<std::thread> workers_;
+
+    std::mutex submit_mutex_; ///< One parallel_for at a time
+    std::mutex mutex_;        ///< BLOCK mode: guards the wake/done handshake
+    std::condition_variable wake_;
+    std::condition_variable done_;
+
+    // The job slot is published by the release store to generation_ (SPIN) or under
+    // mutex_ (BLOCK); workers read it after observing the new generation.
+    TaskRef task_{};
+    std::size_t task_count_ = 0;
+    std::atomic<std::size_t> next_task_{0};
+    std::atomic<std::size_t> busy_workers_{0};
+    std::atomic<std::uint64_t> generation_{0};
+    std::atomic<bool> stop_{false};
+
+    // First exception thrown by a task of the current job; written by whichever thread
+    // wins failed_ and read by the caller once every worker has checked in.
+    std::exception_ptr error_;
+    std::atomic<bool> failed_{false};
+};
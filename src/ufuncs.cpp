@@ -0,0 +1,164 @@
+#include "ufuncs.hpp"
+
+#include "black_scholes.hpp"
+
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+#include <numpy/arrayobject.h>
+#include <numpy/ufuncobject.h>
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace py = pybind11;
+
+namespace {
+
+/// Sentinel for an option-type element that is neither CALL nor PUT.
+constexpr int INVALID_TYPE = -1;
+
+/// Integer codes follow the enum's underlying values: 0 = CALL, 1 = PUT.
+inline int type_code(std::int64_t code) {
+    return code == static_cast<std::int64_t>(OptionType::CALL) ||
+                   code == static_cast<std::int64_t>(OptionType::PUT)
+               ? static_cast<int>(code)
+               : INVALID_TYPE;
+}
+
+/// OptionType members (or any object with __int__). Runs under the GIL; a failed
+/// conversion leaves the Python error set, which NumPy raises after the loop.
+inline int type_code(PyObject* obj) {
+    PyObject* as_int = obj != nullptr ? PyNumber_Long(obj) : nullptr;
+    if (as_int == nullptr) {
+        return INVALID_TYPE;
+    }
+    const long code = PyLong_AsLong(as_int);
+    Py_DECREF(as_int);
+    return type_code(static_cast<std::int64_t>(code));
+}
+
+/// True once an object loop has a pending Python error; the loop must stop calling into
+/// the C API. Integer loops run without the GIL and never check.
+template <typename Code> inline bool conversion_failed() {
+    if constexpr (std::is_same<Code, PyObject*>::value) {
+        return PyErr_Occurred() != nullptr;
+    } else {
+        return false;
+    }
+}
+
+template <typename T> inline T load(char* const* args, const npy_intp* steps, int a, npy_intp i) {
+    return *reinterpret_cast<const T*>(args[a] + i * steps[a]);
+}
+
+template <typename T> inline void store(char** args, const npy_intp* steps, int a, npy_intp i,
+                                        T value) {
+    *reinterpret_cast<T*>(args[a] + i * steps[a]) = value;
+}
+
+/// Inner loop of `price`: five Real inputs, one Code input, one Real output.
+/// Real is float or double (evaluated in double); Code is std::int64_t or PyObject*.
+template <typename Real, typename Code>
+void price_loop(char** args, npy_intp const* dimensions, npy_intp const* steps, void*) {
+    constexpr Real NaN = std::numeric_limits<Real>::quiet_NaN();
+    for (npy_intp i = 0; i < dimensions[0]; ++i) {
+        const int code = type_code(load<Code>(args, steps, 5, i));
+        if (conversion_failed<Code>()) {
+            return;
+        }
+        const Real out =
+            code == INVALID_TYPE
+                ? NaN
+                : static_cast<Real>(price_option(
+                      load<Real>(args, steps, 0, i), load<Real>(args, steps, 1, i),
+                      load<Real>(args, steps, 2, i), load<Real>(args, steps, 3, i),
+                      load<Real>(args, steps, 4, i), static_cast<OptionType>(code)));
+        store<Real>(args, steps, 6, i, out);
+    }
+}
+
+/// Inner loop of `greeks`: same inputs as price_loop, four outputs (delta, gamma,
+/// vega, theta) in compute_greeks' units.
+template <typename Real, typename Code>
+void greeks_loop(char** args, npy_intp const* dimensions, npy_intp const* steps, void*) {
+    constexpr Real NaN = std::numeric_limits<Real>::quiet_NaN();
+    for (npy_intp i = 0; i < dimensions[0]; ++i) {
+        const int code = type_code(load<Code>(args, steps, 5, i));
+        if (conversion_failed<Code>()) {
+            return;
+        }
+        if (code == INVALID_TYPE) {
+            for (int o = 6; o < 10; ++o) {
+                store<Real>(args, steps, o, i, NaN);
+            }
+            continue;
+        }
+        const Greeks g = compute_greeks(
+            load<Real>(args, steps, 0, i), load<Real>(args, steps, 1, i),
+            load<Real>(args, steps, 2, i), load<Real>(args, steps, 3, i),
+            load<Real>(args, steps, 4, i), static_cast<OptionType>(code));
+        store<Real>(args, steps, 6, i, static_cast<Real>(g.delta));
+        store<Real>(args, steps, 7, i, static_cast<Real>(g.gamma));
+        store<Real>(args, steps, 8, i, static_cast<Real>(g.vega));
+        store<Real>(args, steps, 9, i, static_cast<Real>(g.theta));
+    }
+}
+
+// NumPy picks the first loop every input casts to safely, so narrower types go first:
+// float32 arrays stay float32, and OptionType objects only match the object loops.
+constexpr int LOOPS = 4;
+
+PyUFuncGenericFunction price_loops[LOOPS] = {
+    price_loop<float, std::int64_t>,
+    price_loop<double, std::int64_t>,
+    price_loop<float, PyObject*>,
+    price_loop<double, PyObject*>,
+};
+PyUFuncGenericFunction greeks_loops[LOOPS] = {
+    greeks_loop<float, std::int64_t>,
+    greeks_loop<double, std::int64_t>,
+    greeks_loop<float, PyObject*>,
+    greeks_loop<double, PyObject*>,
+};
+void* loop_data[LOOPS] = {nullptr, nullptr, nullptr, nullptr};
+
+#define OPX_INPUTS(real, code) real, real, real, real, real, code
+char price_types[LOOPS * 7] = {
+    OPX_INPUTS(NPY_FLOAT, NPY_INT64), NPY_FLOAT,
+    OPX_INPUTS(NPY_DOUBLE, NPY_INT64), NPY_DOUBLE,
+    OPX_INPUTS(NPY_FLOAT, NPY_OBJECT), NPY_FLOAT,
+    OPX_INPUTS(NPY_DOUBLE, NPY_OBJECT), NPY_DOUBLE,
+};
+char greeks_types[LOOPS * 10] = {
+    OPX_INPUTS(NPY_FLOAT, NPY_INT64), NPY_FLOAT, NPY_FLOAT, NPY_FLOAT, NPY_FLOAT,
+    OPX_INPUTS(NPY_DOUBLE, NPY_INT64), NPY_DOUBLE, NPY_DOUBLE, NPY_DOUBLE, NPY_DOUBLE,
+    OPX_INPUTS(NPY_FLOAT, NPY_OBJECT), NPY_FLOAT, NPY_FLOAT, NPY_FLOAT, NPY_FLOAT,
+    OPX_INPUTS(NPY_DOUBLE, NPY_OBJECT), NPY_DOUBLE, NPY_DOUBLE, NPY_DOUBLE, NPY_DOUBLE,
+};
+#undef OPX_INPUTS
+
+py::object make_ufunc(PyUFuncGenericFunction* loops, char* types, int outputs,
+                      const char* name, const char* doc) {
+    PyObject* ufunc = PyUFunc_FromFuncAndData(loops, loop_data, types, LOOPS, 6, outputs,
+                                              PyUFunc_None, name, doc, 0);
+    if (ufunc == nullptr) {
+        throw py::error_already_set();
+    }
+    return py::reinterpret_steal<py::object>(ufunc);
+}
+
+} // namespace
+
+void register_ufuncs(py::module_& m) {
+    if (_import_array() < 0 || _import_umath() < 0) {
+        throw py::error_already_set();
+    }
+    m.attr("price") = make_ufunc(price_loops, price_types, 1, "price",
+                                 "price(S, K, r, sigma, T, option_type, /, out=None, ...)\n\n"
+                                 "Black-Scholes price as a NumPy ufunc (broadcasts all "
+                                 "arguments). option_type: OptionType or 0 = CALL, 1 = PUT.");
+    m.attr("greeks") = make_ufunc(greeks_loops, greeks_types, 4, "greeks",
+                                  "greeks(S, K, r, sigma, T, option_type, /, out=None, ...)\n\n"
+                                  "Analytical Greeks as a NumPy ufunc. Returns the tuple "
+                                  "(delta, gamma, vega, theta) in compute_greeks' units.");
+}
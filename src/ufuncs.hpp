@@ -0,0 +1,11 @@
+#pragma once
+
+#include <pybind11/pybind11.h>
+
+/// Register the NumPy ufuncs `price` and `greeks` on module `m`.
+///
+/// Both take (S, K, r, sigma, T, option_type) with full broadcasting and `out=` support.
+/// Loops exist for float32 and float64 inputs; option_type may be OptionType members
+/// (object loop, holds the GIL) or integer codes 0 = CALL, 1 = PUT (GIL-free loop).
+/// Unknown codes produce NaN. Built only when CMake finds the NumPy C headers.
+void register_ufuncs(pybind11::module_& m);
@@ -0,0 +1,169 @@
+#include "vol_surface.hpp"
+
+#include "black_scholes.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+/// Throw std::invalid_argument naming `fn` unless both sides of `chain` have as many bids
+/// and asks as strikes.
+void check_sides(const ExpiryChain& chain, const char* fn) {
+    for (const ChainSide* side : {&chain.calls, &chain.puts}) {
+        const std::size_t n = side->strike.size();
+        if (side->bid.size() != n || side->ask.size() != n) {
+            throw std::invalid_argument(std::string(fn) +
+                                        ": strike, bid and ask lengths differ");
+        }
+    }
+}
+
+/// Append the IVs of the liquid quotes of one side to `out` (strike order as quoted).
+/// The side's lengths have been checked.
+void solve_side(const ChainSide& side, OptionType type, double spot, double T,
+                const SurfaceOptions& options, std::vector<SmilePoint>& out) {
+    const std::size_t n = side.strike.size();
+    const double low  = spot * (1.0 - options.strike_band);
+    const double high = spot * (1.0 + options.strike_band);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const double K   = side.strike[i];
+        const double bid = side.bid[i];
+        const double ask = side.ask[i];
+        if (!(bid > 0.0 && ask > 0.0)) {
+            continue;
+        }
+        if ((ask - bid) / ask > options.max_spread_ratio) {
+            continue;
+        }
+        if (!(K >= low && K <= high)) {
+            continue;
+        }
+        const double iv = implied_vol(0.5 * (bid + ask), spot, K, options.rate, T, type);
+        if (!std::isnan(iv)) {
+            out.push_back({K, iv});
+        }
+    }
+}
+
+/// Sort by strike and keep the last quote of each repeated strike.
+void sort_unique_last(std::vector<SmilePoint>& points) {
+    std::stable_sort(points.begin(), points.end(),
+                     [](const SmilePoint& a, const SmilePoint& b) { return a.strike < b.strike; });
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        if (kept > 0 && points[kept - 1].strike == points[i].strike) {
+            points[kept - 1] = points[i];
+        } else {
+            points[kept++] = points[i];
+        }
+    }
+    points.resize(kept);
+}
+
+} // namespace
+
+std::vector<SmilePoint> solve_smile(const ExpiryChain& chain, double spot,
+                                    const SurfaceOptions& options) {
+    std::vector<SmilePoint> calls;
+    std::vector<SmilePoint> puts;
+    check_sides(chain, "solve_smile");
+    if (chain.T > 0.0) {
+        solve_side(chain.calls, OptionType::CALL, spot, chain.T, options, calls);
+        solve_side(chain.puts, OptionType::PUT, spot, chain.T, options, puts);
+    }
+    sort_unique_last(calls);
+    sort_unique_last(puts);
+
+    // Merge two strike-sorted lists: OTM side wins, the other side fills gaps.
+    std::vector<SmilePoint> smile;
+    smile.reserve(calls.size() + puts.size());
+    std::size_t c = 0;
+    std::size_t p = 0;
+    while (c < calls.size() || p < puts.size()) {
+        const bool take_call = p == puts.size() ||
+                               (c < calls.size() && calls[c].strike < puts[p].strike);
+        const bool take_put  = c == calls.size() ||
+                              (p < puts.size() && puts[p].strike < calls[c].strike);
+        if (take_call) {
+            smile.push_back(calls[c++]);
+        } else if (take_put) {
+            smile.push_back(puts[p++]);
+        } else { // quoted on both sides
+            smile.push_back(calls[c].strike > spot ? calls[c] : puts[p]);
+            ++c;
+            ++p;
+        }
+    }
+    return smile;
+}
+
+IvSurface build_iv_surface(Span<const ExpiryChain> chains, double spot,
+                           const SurfaceOptions& options, ThreadPool* pool) {
+    const std::size_t n = chains.size();
+    // Reject bad input before any expiry is handed to the pool.
+    for (const ExpiryChain& chain : chains) {
+        check_sides(chain, "build_iv_surface");
+    }
+    std::vector<std::vector<SmilePoint>> smiles(n);
+    const auto solve = [&](std::size_t e) { smiles[e] = solve_smile(chains[e], spot, options); };
+    if (pool != nullptr && n > 1) {
+        pool->parallel_for(n, solve);
+    } else {
+        for (std::size_t e = 0; e < n; ++e) {
+            solve(e);
+        }
+    }
+
+    IvSurface surface;
+    surface.quoted.resize(n);
+    for (std::size_t e = 0; e < n; ++e) {
+        surface.quoted[e] = smiles[e].size();
+        if (!smiles[e].empty()) {
+            surface.expiry.push_back(e);
+        }
+    }
+    std::stable_sort(surface.expiry.begin(), surface.expiry.end(),
+                     [&](std::size_t a, std::size_t b) { return chains[a].T < chains[b].T; });
+    if (surface.expiry.empty()) {
+        return surface;
+    }
+
+    // Inner join: walk the first smile and keep strikes every other smile also has.
+    // Each smile is strike-sorted, so one cursor per expiry suffices.
+    const std::size_t rows = surface.expiry.size();
+    std::vector<std::size_t> cursor(rows, 0);
+    for (const SmilePoint& point : smiles[surface.expiry[0]]) {
+        bool everywhere = true;
+        for (std::size_t row = 1; row < rows && everywhere; ++row) {
+            const auto& smile = smiles[surface.expiry[row]];
+            std::size_t& j    = cursor[row];
+            while (j < smile.size() && smile[j].strike < point.strike) {
+                ++j;
+            }
+            everywhere = j < smile.size() && smile[j].strike == point.strike;
+        }
+        if (everywhere) {
+            surface.strikes.push_back(point.strike);
+        }
+    }
+
+    const std::size_t cols = surface.strikes.size();
+    surface.T.resize(rows);
+    surface.iv.resize(rows * cols);
+    for (std::size_t row = 0; row < rows; ++row) {
+        const auto& smile = smiles[surface.expiry[row]];
+        surface.T[row]    = chains[surface.expiry[row]].T;
+        std::size_t j     = 0;
+        for (std::size_t col = 0; col < cols; ++col) {
+            while (smile[j].strike < surface.strikes[col]) {
+                ++j;
+            }
+            surface.iv[row * cols + col] = smile[j].iv;
+        }
+    }
+    return surface;
+}
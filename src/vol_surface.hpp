@@ -0,0 +1,63 @@
+#pragma once
+
+#include "span.hpp"
+#include "thread_pool.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/// Quotes for one side (calls or puts) of one expiry; equal-length columns.
+struct ChainSide {
+    Span<const double> strike;
+    Span<const double> bid;
+    Span<const double> ask;
+};
+
+/// One expiry of an option chain.
+struct ExpiryChain {
+    double T; ///< Time to expiry in years; expiries with T <= 0 are skipped
+    ChainSide calls;
+    ChainSide puts;
+};
+
+/// Liquidity filters and rate for build_iv_surface; defaults match the Python scripts.
+struct SurfaceOptions {
+    double max_spread_ratio = 0.50; ///< Drop quotes with (ask - bid) / ask above this
+    double strike_band      = 0.20; ///< Keep strikes within spot·(1 ± band)
+    double rate             = 0.05; ///< Risk-free rate for the IV solve
+};
+
+/// Implied volatility at one strike of one expiry.
+struct SmilePoint {
+    double strike;
+    double iv;
+};
+
+/// Dense implied-vol surface: one row per kept expiry, one column per common strike.
+struct IvSurface {
+    std::vector<double> strikes;      ///< Strikes with an IV in every kept expiry, ascending
+    std::vector<double> T;            ///< T of each row, ascending
+    std::vector<std::size_t> expiry;  ///< Input index of each row
+    std::vector<std::size_t> quoted;  ///< Liquid strikes per input expiry (before the join)
+    std::vector<double> iv;           ///< Row-major (T.size() x strikes.size()) decimal IVs
+
+    double at(std::size_t row, std::size_t col) const { return iv[row * strikes.size() + col]; }
+};
+
+/// Out-of-the-money smile of one expiry, ascending by strike.
+///
+/// Each side is filtered in order (bid and ask positive, relative spread, strike band),
+/// the mid price is inverted with implied_vol, and quotes that fail to solve are dropped.
+/// Puts supply strikes at or below spot and calls strikes above it; a strike quoted on
+/// the wrong side only is taken from that side. A strike repeated within one side keeps
+/// its last quote. Throws std::invalid_argument if a side's strike, bid and ask columns
+/// differ in length.
+std::vector<SmilePoint> solve_smile(const ExpiryChain& chain, double spot,
+                                    const SurfaceOptions& options = {});
+
+/// Solve every expiry's smile (in parallel on `pool` when given), drop expiries with no
+/// liquid strikes, inner-join the rest on exact strike, and lay the result out densely
+/// with expiries sorted by T. Results do not depend on the pool. Every chain is checked
+/// as in solve_smile before any is solved.
+IvSurface build_iv_surface(Span<const ExpiryChain> chains, double spot,
+                           const SurfaceOptions& options = {}, ThreadPool* pool = nullptr);
@@ -0,0 +1,511 @@
+#include "warm_state.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace {
+
+constexpr char WARM_MAGIC[8]         = {'O', 'P', 'X', 'W', 'A', 'R', 'M', '1'};
+constexpr std::uint32_t WARM_VERSION = 1;
+constexpr std::size_t SECTION_ALIGN  = 64;
+
+// Surface index arrays are written as they sit in memory.
+static_assert(sizeof(std::size_t) == sizeof(std::uint64_t), "warm state needs 64-bit size_t");
+
+enum class Section : std::uint32_t { S, K, R, SIGMA, T, TYPE, PRICES, GREEKS, SURFACE, CACHE };
+
+struct alignas(SECTION_ALIGN) FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t sections;
+    std::uint64_t rows;  ///< Contracts in the book
+    std::uint64_t bytes; ///< Whole file, so truncation is caught on open
+};
+
+struct SectionEntry {
+    std::uint32_t kind;
+    std::uint32_t reserved;
+    std::uint64_t offset; ///< From the start of the file; a multiple of SECTION_ALIGN
+    std::uint64_t bytes;
+};
+
+/// Fixed start of a SURFACE section, followed by strikes, T, expiry, quoted, iv and the
+/// name, each padded to SECTION_ALIGN.
+struct SurfaceHeader {
+    std::uint64_t rows;
+    std::uint64_t cols;
+    std::uint64_t expiries; ///< Input expiries (length of IvSurface::quoted)
+    std::uint64_t name_bytes;
+};
+
+/// Fixed start of the CACHE section, followed by the entry images.
+struct CacheHeader {
+    CacheTolerances tolerances;
+    std::uint64_t entries;
+};
+
+inline std::size_t round_up(std::size_t n, std::size_t multiple) {
+    return (n + multiple - 1) / multiple * multiple;
+}
+
+// Overflow-checked size arithmetic for lengths read from a file: false instead of a
+// wrapped result.
+inline bool checked_add(std::size_t a, std::size_t b, std::size_t& out) {
+    if (a > SIZE_MAX - b) {
+        return false;
+    }
+    out = a + b;
+    return true;
+}
+
+inline bool checked_mul(std::size_t a, std::size_t b, std::size_t& out) {
+    if (b != 0 && a > SIZE_MAX / b) {
+        return false;
+    }
+    out = a * b;
+    return true;
+}
+
+inline bool checked_round_up(std::size_t n, std::size_t multiple, std::size_t& out) {
+    if (!checked_add(n, multiple - 1, out)) {
+        return false;
+    }
+    out = out / multiple * multiple;
+    return true;
+}
+
+/// Contiguous bytes written at the next SECTION_ALIGN boundary of a section.
+struct Piece {
+    const void* data;
+    std::size_t bytes;
+};
+
+struct PendingSection {
+    Section kind;
+    std::vector<Piece> pieces;
+
+    std::size_t bytes() const {
+        std::size_t n = 0;
+        for (const Piece& p : pieces) {
+            n += round_up(p.bytes, SECTION_ALIGN);
+        }
+        return n;
+    }
+};
+
+/// Byte sizes of the pieces of a surface section, in file order, and their padded total
+/// plus the name in `total`. False if any of it overflows size_t.
+bool surface_pieces(const SurfaceHeader& h, std::size_t sizes[6], std::size_t& total) {
+    std::size_t cells = 0;
+    sizes[0]          = sizeof(SurfaceHeader);
+    if (!checked_mul(h.cols, sizeof(double), sizes[1]) ||
+        !checked_mul(h.rows, sizeof(double), sizes[2]) ||
+        !checked_mul(h.rows, sizeof(std::uint64_t), sizes[3]) ||
+        !checked_mul(h.expiries, sizeof(std::uint64_t), sizes[4]) ||
+        !checked_mul(h.rows, h.cols, cells) || !checked_mul(cells, sizeof(double), sizes[5])) {
+        return false;
+    }
+    total = h.name_bytes;
+    for (std::size_t k = 0; k < 6; ++k) {
+        std::size_t padded = 0;
+        if (!checked_round_up(sizes[k], SECTION_ALIGN, padded) ||
+            !checked_add(total, padded, total)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::runtime_error file_error(const char* fn, const std::string& path) {
+    return std::runtime_error(std::string(fn) + ": " + path + ": " + std::strerror(errno));
+}
+
+std::runtime_error format_error(const std::string& path, const char* what) {
+    return std::runtime_error("WarmStateFile: " + path + " is not a v1 warm state (" + what +
+                              ")");
+}
+
+struct FdGuard {
+    int fd;
+    ~FdGuard() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+};
+
+bool write_fully(int fd, const void* data, std::size_t bytes) {
+    const auto* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        const ssize_t n = write(fd, p, bytes);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        bytes -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+/// fsync the directory holding `path`, so a rename into it survives a crash.
+/// Filesystems that cannot sync directories (EINVAL) are accepted as they are.
+bool sync_parent_dir(const std::string& path) {
+    const std::size_t slash = path.find_last_of('/');
+    const std::string dir   = slash == std::string::npos ? "."
+                              : slash == 0               ? "/"
+                                                         : path.substr(0, slash);
+    FdGuard fd{open(dir.c_str(), O_RDONLY | O_DIRECTORY)};
+    return fd.fd >= 0 && (fsync(fd.fd) == 0 || errno == EINVAL);
+}
+
+} // namespace
+
+void save_warm_state(const std::string& path, const WarmState& state) {
+    const BatchView& book = state.contracts;
+    const std::size_t n   = book.size();
+    if ((!state.prices.empty() && state.prices.size() != n) ||
+        (!state.greeks.empty() && state.greeks.size() != n)) {
+        throw std::invalid_argument("save_warm_state: prices or greeks differ from the book in "
+                                    "length");
+    }
+    for (const NamedSurface& s : state.surfaces) {
+        const IvSurface& surface = s.surface;
+        if (surface.expiry.size() != surface.T.size() ||
+            surface.iv.size() != surface.T.size() * surface.strikes.size()) {
+            throw std::invalid_argument("save_warm_state: surface " + s.name +
+                                        " has inconsistent dimensions");
+        }
+    }
+
+    std::vector<PendingSection> sections;
+    const auto column = [&](Section kind, const void* data, std::size_t bytes) {
+        sections.push_back({kind, {Piece{data, bytes}}});
+    };
+    if (n > 0) {
+        column(Section::S, book.S.data(), n * sizeof(double));
+        column(Section::K, book.K.data(), n * sizeof(double));
+        column(Section::R, book.r.data(), n * sizeof(double));
+        column(Section::SIGMA, book.sigma.data(), n * sizeof(double));
+        column(Section::T, book.T.data(), n * sizeof(double));
+        column(Section::TYPE, book.option_type.data(), n * sizeof(OptionType));
+    }
+    if (!state.prices.empty()) {
+        column(Section::PRICES, state.prices.data(), n * sizeof(double));
+    }
+    if (!state.greeks.empty()) {
+        column(Section::GREEKS, state.greeks.data(), n * sizeof(Greeks));
+    }
+
+    std::vector<SurfaceHeader> surface_headers;
+    surface_headers.reserve(state.surfaces.size()); // pieces point into it
+    for (const NamedSurface& s : state.surfaces) {
+        const IvSurface& surface = s.surface;
+        surface_headers.push_back({surface.T.size(), surface.strikes.size(),
+                                   surface.quoted.size(), s.name.size()});
+        std::size_t sizes[6];
+        std::size_t total = 0;
+        surface_pieces(surface_headers.back(), sizes, total); // in-memory sizes cannot overflow
+        sections.push_back({Section::SURFACE,
+                            {Piece{&surface_headers.back(), sizes[0]},
+                             Piece{surface.strikes.data(), sizes[1]},
+                             Piece{surface.T.data(), sizes[2]},
+                             Piece{surface.expiry.data(), sizes[3]},
+                             Piece{surface.quoted.data(), sizes[4]},
+                             Piece{surface.iv.data(), sizes[5]},
+                             Piece{s.name.data(), s.name.size()}}});
+    }
+
+    CacheHeader cache_header{};
+    std::vector<CacheEntryImage> cache_entries;
+    if (state.cache != nullptr) {
+        state.cache->dump(cache_entries);
+        cache_header.tolerances = state.cache->tolerances();
+        cache_header.entries    = cache_entries.size();
+        sections.push_back({Section::CACHE,
+                            {Piece{&cache_header, sizeof cache_header},
+                             Piece{cache_entries.data(),
+                                   cache_entries.size() * sizeof(CacheEntryImage)}}});
+    }
+
+    // Lay out: header, section table, then each section on a SECTION_ALIGN boundary.
+    std::vector<SectionEntry> table(sections.size());
+    std::size_t offset = round_up(sizeof(FileHeader) + table.size() * sizeof(SectionEntry),
+                                  SECTION_ALIGN);
+    for (std::size_t i = 0; i < sections.size(); ++i) {
+        table[i] = {static_cast<std::uint32_t>(sections[i].kind), 0, offset,
+                    sections[i].bytes()};
+        offset += table[i].bytes;
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, WARM_MAGIC, sizeof header.magic);
+    header.version  = WARM_VERSION;
+    header.sections = static_cast<std::uint32_t>(sections.size());
+    header.rows     = n;
+    header.bytes    = offset;
+
+    // Write and fsync the temporary file, rename it over `path`, then fsync the directory:
+    // after a crash the name refers to either the old file or the complete new one.
+    const std::string tmp = path + ".tmp";
+    {
+        FdGuard out{open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+        if (out.fd < 0) {
+            throw file_error("save_warm_state", tmp);
+        }
+        static const char zeros[SECTION_ALIGN] = {};
+        std::size_t written                    = 0;
+        bool ok                                = true;
+        const auto put = [&](const void* data, std::size_t bytes) {
+            ok = ok && write_fully(out.fd, data, bytes);
+            written += bytes;
+        };
+        const auto pad = [&] {
+            put(zeros, round_up(written, SECTION_ALIGN) - written);
+        };
+        put(&header, sizeof header);
+        put(table.data(), table.size() * sizeof(SectionEntry));
+        pad();
+        for (const PendingSection& section : sections) {
+            for (const Piece& piece : section.pieces) {
+                put(piece.data, piece.bytes);
+                pad();
+            }
+        }
+        if (!ok || fsync(out.fd) != 0) {
+            const auto err = file_error("save_warm_state", tmp);
+            std::remove(tmp.c_str());
+            throw err;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        const auto err = file_error("save_warm_state", path);
+        std::remove(tmp.c_str());
+        throw err;
+    }
+    if (!sync_parent_dir(path)) {
+        throw file_error("save_warm_state", path);
+    }
+}
+
+WarmStateFile::WarmStateFile(const std::string& path) : path_(path) {
+    FdGuard fd{open(path.c_str(), O_RDONLY)};
+    if (fd.fd < 0) {
+        throw file_error("WarmStateFile", path);
+    }
+    struct stat st {};
+    if (fstat(fd.fd, &st) != 0) {
+        throw file_error("WarmStateFile", path);
+    }
+    bytes_ = static_cast<std::size_t>(st.st_size);
+    if (bytes_ < sizeof(FileHeader)) {
+        throw format_error(path, "too short");
+    }
+    void* p = mmap(nullptr, bytes_, PROT_READ, MAP_PRIVATE, fd.fd, 0);
+    if (p == MAP_FAILED) {
+        throw file_error("WarmStateFile", path);
+    }
+    base_ = static_cast<char*>(p);
+
+    try {
+        const auto* header = reinterpret_cast<const FileHeader*>(base_);
+        if (std::memcmp(header->magic, WARM_MAGIC, sizeof header->magic) != 0 ||
+            header->version != WARM_VERSION) {
+            throw format_error(path, "bad magic or version");
+        }
+        if (header->bytes != bytes_ ||
+            sizeof(FileHeader) + header->sections * sizeof(SectionEntry) > bytes_) {
+            throw format_error(path, "truncated");
+        }
+        const std::size_t n = header->rows;
+        const auto* table   = reinterpret_cast<const SectionEntry*>(base_ + sizeof(FileHeader));
+
+        const char* columns[8] = {};
+        for (std::uint32_t i = 0; i < header->sections; ++i) {
+            const SectionEntry& entry = table[i];
+            if (entry.offset % SECTION_ALIGN != 0 || entry.offset > bytes_ ||
+                entry.bytes > bytes_ - entry.offset) {
+                throw format_error(path, "section out of bounds");
+            }
+            const char* section = base_ + entry.offset;
+            const auto kind     = static_cast<Section>(entry.kind);
+            switch (kind) {
+            case Section::S:
+            case Section::K:
+            case Section::R:
+            case Section::SIGMA:
+            case Section::T:
+            case Section::TYPE:
+            case Section::PRICES:
+            case Section::GREEKS: {
+                static constexpr std::size_t widths[] = {
+                    sizeof(double), sizeof(double),     sizeof(double), sizeof(double),
+                    sizeof(double), sizeof(OptionType), sizeof(double), sizeof(Greeks),
+                };
+                if (entry.bytes / widths[entry.kind] < n) {
+                    throw format_error(path, "short column");
+                }
+                columns[entry.kind] = section;
+                break;
+            }
+            case Section::SURFACE: {
+                SurfaceHeader h{};
+                if (entry.bytes < sizeof h) {
+                    throw format_error(path, "short surface");
+                }
+                std::memcpy(&h, section, sizeof h);
+                std::size_t sizes[6];
+                std::size_t need = 0;
+                if (!surface_pieces(h, sizes, need) || need > entry.bytes) {
+                    throw format_error(path, "short surface");
+                }
+                surfaces_.push_back({std::string(section + need - h.name_bytes, h.name_bytes),
+                                     section});
+                break;
+            }
+            case Section::CACHE: {
+                CacheHeader h{};
+                if (entry.bytes < sizeof h) {
+                    throw format_error(path, "short cache");
+                }
+                std::memcpy(&h, section, sizeof h);
+                const std::size_t start = round_up(sizeof h, SECTION_ALIGN);
+                if (h.entries > (entry.bytes - std::min<std::size_t>(start, entry.bytes)) /
+                                    sizeof(CacheEntryImage)) {
+                    throw format_error(path, "short cache");
+                }
+                cache_tolerances_ = h.tolerances;
+                cache_            = Span<const CacheEntryImage>(
+                    reinterpret_cast<const CacheEntryImage*>(section + start), h.entries);
+                break;
+            }
+            default:
+                break; // unknown sections are skipped
+            }
+        }
+
+        if (n > 0) {
+            for (int c = 0; c <= static_cast<int>(Section::TYPE); ++c) {
+                if (columns[c] == nullptr) {
+                    throw format_error(path, "missing contract column");
+                }
+            }
+            const auto doubles = [&](Section c) {
+                return Span<const double>(
+                    reinterpret_cast<const double*>(columns[static_cast<int>(c)]), n);
+            };
+            contracts_ = BatchView(
+                doubles(Section::S), doubles(Section::K), doubles(Section::R),
+                doubles(Section::SIGMA), doubles(Section::T),
+                Span<const OptionType>(reinterpret_cast<const OptionType*>(
+                                           columns[static_cast<int>(Section::TYPE)]),
+                                       n));
+            if (columns[static_cast<int>(Section::PRICES)] != nullptr) {
+                prices_ = doubles(Section::PRICES);
+            }
+            if (columns[static_cast<int>(Section::GREEKS)] != nullptr) {
+                greeks_ = Span<const Greeks>(reinterpret_cast<const Greeks*>(
+                                                 columns[static_cast<int>(Section::GREEKS)]),
+                                             n);
+            }
+        }
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+WarmStateFile::WarmStateFile(WarmStateFile&& other) noexcept
+    : path_(std::move(other.path_)), base_(other.base_), bytes_(other.bytes_),
+      contracts_(other.contracts_), prices_(other.prices_), greeks_(other.greeks_),
+      surfaces_(std::move(other.surfaces_)), cache_tolerances_(other.cache_tolerances_),
+      cache_(other.cache_) {
+    other.base_ = nullptr;
+}
+
+WarmStateFile& WarmStateFile::operator=(WarmStateFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        path_             = std::move(other.path_);
+        base_             = other.base_;
+        bytes_            = other.bytes_;
+        contracts_        = other.contracts_;
+        prices_           = other.prices_;
+        greeks_           = other.greeks_;
+        surfaces_         = std::move(other.surfaces_);
+        cache_tolerances_ = other.cache_tolerances_;
+        cache_            = other.cache_;
+        other.base_       = nullptr;
+    }
+    return *this;
+}
+
+WarmStateFile::~WarmStateFile() { release(); }
+
+void WarmStateFile::release() {
+    if (base_ != nullptr) {
+        munmap(base_, bytes_);
+        base_ = nullptr;
+    }
+}
+
+IvSurface WarmStateFile::surface(std::size_t i) const {
+    const char* section = surfaces_.at(i).base;
+    SurfaceHeader h{};
+    std::memcpy(&h, section, sizeof h);
+    std::size_t sizes[6];
+    std::size_t total = 0;
+    surface_pieces(h, sizes, total); // validated when the file was opened
+
+    const char* pieces[6];
+    for (std::size_t k = 0; k < 6; ++k) {
+        pieces[k] = section;
+        section += round_up(sizes[k], SECTION_ALIGN);
+    }
+    const auto copy = [&](auto& out, std::size_t k, std::size_t count) {
+        using T = typename std::decay_t<decltype(out)>::value_type;
+        out.resize(count);
+        std::memcpy(out.data(), pieces[k], count * sizeof(T));
+    };
+    IvSurface surface;
+    copy(surface.strikes, 1, h.cols);
+    copy(surface.T, 2, h.rows);
+    copy(surface.expiry, 3, h.rows);
+    copy(surface.quoted, 4, h.expiries);
+    copy(surface.iv, 5, h.rows * h.cols);
+    return surface;
+}
+
+std::size_t WarmStateFile::find_surface(const std::string& name) const {
+    std::size_t i = 0;
+    while (i < surfaces_.size() && surfaces_[i].name != name) {
+        ++i;
+    }
+    return i;
+}
+
+std::size_t WarmStateFile::warm(PricingCache& cache) const {
+    if (cache_.empty()) {
+        return 0;
+    }
+    const CacheTolerances& a = cache.tolerances();
+    const CacheTolerances& b = cache_tolerances_;
+    if (a.S != b.S || a.K != b.K || a.r != b.r || a.sigma != b.sigma || a.T != b.T) {
+        throw std::invalid_argument("WarmStateFile::warm: " + path_ +
+                                    " was saved from a cache with different tolerances");
+    }
+    return cache.warm(cache_);
+}
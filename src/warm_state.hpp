@@ -0,0 +1,95 @@
+#pragma once
+
+#include "batch_pricer.hpp"
+#include "price_cache.hpp"
+#include "span.hpp"
+#include "vol_surface.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/// An IV surface plus the name it is restored under (typically the underlying).
+struct NamedSurface {
+    std::string name;
+    IvSurface surface;
+};
+
+/// Warmed engine state to persist with save_warm_state. Every part is optional; prices
+/// and greeks, when given, have one row per contract.
+struct WarmState {
+    BatchView contracts;                 ///< Prepared book, ready for the batch kernels
+    Span<const double> prices;           ///< Last prices of the book
+    Span<const Greeks> greeks;           ///< Last Greeks of the book
+    Span<const NamedSurface> surfaces;   ///< Solved IV surfaces
+    const PricingCache* cache = nullptr; ///< Warm quote cache, restored with its tolerances
+};
+
+/// Write `state` to `path` as a memory-mappable file: a header and section table, then
+/// every column and array starting on a 64-byte boundary. The file is written and
+/// fsynced under a temporary name, renamed into place, and the directory is fsynced, so
+/// after a crash `path` holds either the previous file or the complete new one.
+/// Native byte order, same host type only. Throws std::invalid_argument if prices or
+/// greeks do not match the book and std::runtime_error on I/O failure.
+void save_warm_state(const std::string& path, const WarmState& state);
+
+/// Read-only mapping of a file written by save_warm_state.
+///
+/// Opening validates the header and section bounds and nothing else, so startup costs
+/// one mmap however large the book: contracts(), prices() and greeks() point into the
+/// mapping and feed the batch kernels directly, with pages faulted in on first use.
+/// Surfaces are small and copied out on request; warm() refills a PricingCache.
+class WarmStateFile {
+  public:
+    /// Throws std::runtime_error if the file is missing, truncated or not a warm state.
+    explicit WarmStateFile(const std::string& path);
+
+    WarmStateFile(WarmStateFile&& other) noexcept;
+    WarmStateFile& operator=(WarmStateFile&& other) noexcept;
+    ~WarmStateFile();
+
+    WarmStateFile(const WarmStateFile&)            = delete;
+    WarmStateFile& operator=(const WarmStateFile&) = delete;
+
+    /// Contracts in the book.
+    std::size_t size() const { return contracts_.size(); }
+
+    BatchView contracts() const { return contracts_; }
+    Span<const double> prices() const { return prices_; } ///< Empty if not saved
+    Span<const Greeks> greeks() const { return greeks_; } ///< Empty if not saved
+
+    std::size_t surface_count() const { return surfaces_.size(); }
+    const std::string& surface_name(std::size_t i) const { return surfaces_[i].name; }
+
+    /// Copy of surface i.
+    IvSurface surface(std::size_t i) const;
+
+    /// Index of the surface saved as `name`, or surface_count() if there is none.
+    std::size_t find_surface(const std::string& name) const;
+
+    /// Cache entries saved (0 if no cache was given).
+    std::size_t cache_entries() const { return cache_.size(); }
+
+    /// Refill `cache` with the saved entries; returns how many were stored.
+    /// Throws std::invalid_argument if its tolerances differ from the saved cache's.
+    std::size_t warm(PricingCache& cache) const;
+
+  private:
+    struct SurfaceSection {
+        std::string name;
+        const char* base; ///< Start of the section's fixed header
+    };
+
+    void release();
+
+    std::string path_;
+    char* base_        = nullptr;
+    std::size_t bytes_ = 0;
+
+    BatchView contracts_;
+    Span<const double> prices_;
+    Span<const Greeks> greeks_;
+    std::vector<SurfaceSection> surfaces_;
+    CacheTolerances cache_tolerances_{};
+    Span<const CacheEntryImage> cache_;
+};
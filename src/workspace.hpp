@@ -0,0 +1,27 @@
+#pragma once
+
+#include "batch_pricer.hpp"
+#include "dedup.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Caller-owned scratch memory for the batch engines.
+///
+/// Create one per thread, pass it to every span-based entry point, and keep it alive:
+/// each buffer grows to the largest request seen and is reused afterwards, so once
+/// warmed up the pricing path performs no heap allocation. Contents are scratch and
+/// carry no meaning between calls.
+struct PricingWorkspace {
+    DedupArena dedup;                       ///< price_batch_dedup hash table and gather buffers
+    ContractBatch gather;                   ///< Rows gathered for a sub-batch (strategies, EOD)
+    std::vector<Contract> contracts;        ///< AoS gather buffer
+    std::vector<std::size_t> rows;          ///< Row or slot indices of a gathered sub-batch
+    std::vector<double> prices;             ///< Prices of a gathered sub-batch
+    std::vector<Greeks> greeks;             ///< Greeks of a gathered sub-batch
+    std::vector<std::uint8_t> mask;         ///< Per-row flags (e.g. changed rows)
+    std::vector<double> partials;           ///< Block partials for deterministic reductions
+    std::vector<PreparedContract> prepared; ///< Hoisted per-combination terms of a grid sweep
+    std::vector<double> spots;              ///< Dividend-adjusted spots (escrowed model)
+};
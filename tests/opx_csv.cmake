@@ -0,0 +1,56 @@
+# Runs opx on tests/data/opx_chain.csv and checks its CSV output.
+# The input has blank lines before a header whose columns are out of order, so this also
+# covers header detection and name-based column mapping. Values are compared on their
+# leading digits; CMake has no floating-point arithmetic. The chain is read twice: from
+# the file, and through a pipe named by path (/dev/stdin), which must not lose the bytes
+# the snapshot probe would otherwise read.
+#
+# Invoked by CTest: cmake -DOPX=<opx binary> -DINPUT=<csv> -P opx_csv.cmake
+
+set(opx_args --quiet --threads 2 --chunk 2 --compute price,greeks,iv)
+
+# One regex per line: header, then price, delta, gamma, vega, theta, iv per row.
+set(expected
+    "^price,delta,gamma,vega,theta,iv$"
+    "^10\\.45058[0-9]*,0\\.63683[0-9]*,0\\.01876[0-9]*,0\\.37524[0-9]*,-0\\.01757[0-9]*,0\\.(2|1999999)[0-9]*$"
+    "^10\\.19056[0-9]*,-0\\.66511[0-9]*,0\\.02575[0-9]*,0\\.25757[0-9]*,-0\\.00360[0-9]*,0\\.(2|1999999)[0-9]*$"
+    "^12\\.85819[0-9]*,0\\.80530[0-9]*,0\\.01836[0-9]*,0\\.13772[0-9]*,-0\\.03190[0-9]*,nan$"
+)
+
+function(check_output label status output errors)
+    if(NOT status EQUAL 0)
+        message(FATAL_ERROR "${label}: opx exited with ${status}: ${errors}")
+    endif()
+    string(STRIP "${output}" output)
+    string(REPLACE "\n" ";" lines "${output}")
+    list(LENGTH lines count)
+    if(NOT count EQUAL 4)
+        message(FATAL_ERROR "${label}: expected a header and 3 rows, got:\n${output}")
+    endif()
+    foreach(i RANGE 3)
+        list(GET lines ${i} line)
+        list(GET expected ${i} pattern)
+        if(NOT line MATCHES "${pattern}")
+            message(FATAL_ERROR
+                "${label}: line ${i} of opx output does not match ${pattern}:\n${line}")
+        endif()
+    endforeach()
+endfunction()
+
+execute_process(
+    COMMAND "${OPX}" ${opx_args} "${INPUT}"
+    RESULT_VARIABLE status
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE errors
+)
+check_output("file input" "${status}" "${output}" "${errors}")
+
+execute_process(
+    COMMAND "${CMAKE_COMMAND}" -E cat "${INPUT}"
+    COMMAND "${OPX}" ${opx_args} /dev/stdin
+    RESULTS_VARIABLE statuses
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE errors
+)
+list(GET statuses 1 status)
+check_output("piped input" "${status}" "${output}" "${errors}")
@@ -0,0 +1,166 @@
+#include "../src/batch_pricer.hpp"
+#include "../src/dedup.hpp"
+#include "../src/dividends.hpp"
+#include "../src/eod_risk.hpp"
+#include "../src/grid.hpp"
+#include "../src/reduction.hpp"
+#include "../src/strategy.hpp"
+#include "../src/workspace.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Allocation hook: every global operator new bumps a counter while counting is on.
+// Each test warms its workspace once, then asserts a second call allocates nothing.
+// Atomics because pool worker threads run inside the counted region too.
+// ---------------------------------------------------------------------------
+static std::atomic<bool> g_counting{false};
+static std::atomic<std::size_t> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    if (g_counting) {
+        ++g_allocations;
+    }
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    if (g_counting) {
+        ++g_allocations;
+    }
+    const auto a = static_cast<std::size_t>(align);
+    if (void* p = std::aligned_alloc(a, (size + a - 1) / a * a)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+/// Run `f` with counting on; returns the number of heap allocations it made.
+template <typename F> static std::size_t count_allocations(F&& f) {
+    g_allocations = 0;
+    g_counting    = true;
+    f();
+    g_counting = false;
+    return g_allocations;
+}
+
+static std::vector<Contract> make_contracts(std::size_t n) {
+    std::vector<Contract> contracts;
+    for (std::size_t i = 0; i < n; ++i) {
+        const OptionType type = (i % 2 == 0) ? OptionType::CALL : OptionType::PUT;
+        contracts.push_back({100.0, 80.0 + static_cast<double>(i % 40), 0.05, 0.20,
+                             0.25 + 0.25 * static_cast<double>(i % 4), type});
+    }
+    return contracts;
+}
+
+// ---------------------------------------------------------------------------
+// Test 1: Plain batch kernels write into caller-owned spans
+// ---------------------------------------------------------------------------
+static void test_batch_kernels_do_not_allocate() {
+    const std::vector<Contract> contracts = make_contracts(1000);
+    ContractBatch batch;
+    for (const auto& c : contracts) {
+        batch.push_back(c);
+    }
+    std::vector<double> prices(contracts.size());
+    std::vector<Greeks> greeks(contracts.size());
+
+    const std::size_t n = count_allocations([&] {
+        price_batch(contracts, prices);
+        price_batch(batch, prices);
+        greeks_batch(contracts, greeks);
+    });
+    assert(n == 0 && "Span-based batch kernels must not allocate");
+    assert(count_allocations([&] { price_batch(contracts); }) > 0 &&
+           "Hook must observe the allocating convenience form");
+}
+
+// ---------------------------------------------------------------------------
+// Test 2: Workspace-backed engines are allocation-free once warm
+// ---------------------------------------------------------------------------
+static void test_warm_workspace_engines_do_not_allocate() {
+    const std::vector<Contract> contracts = make_contracts(1000);
+    std::vector<double> prices(contracts.size());
+    PricingWorkspace ws;
+
+    // Dedup
+    price_batch_dedup(contracts, prices, ws.dedup); // warm
+    assert(count_allocations([&] { price_batch_dedup(contracts, prices, ws.dedup); }) == 0 &&
+           "price_batch_dedup must not allocate on a warm arena");
+
+    // Strategies
+    std::vector<Strategy> strategies;
+    for (std::size_t i = 0; i + 1 < contracts.size(); i += 2) {
+        strategies.push_back({{{i, 1.0}, {i + 1, -1.0}}});
+    }
+    std::vector<StrategyValue> values(strategies.size());
+    price_strategies(contracts, strategies, values, ws); // warm
+    assert(count_allocations([&] { price_strategies(contracts, strategies, values, ws); }) == 0 &&
+           "price_strategies must not allocate on a warm workspace");
+
+    // Incremental EOD diff
+    RiskSnapshot previous;
+    for (const auto& c : contracts) {
+        previous.inputs.push_back(c);
+    }
+    previous.prices = price_batch(previous.inputs);
+    ContractBatch today = previous.inputs;
+    today.S[3]          = 101.0;
+    run_incremental(today, previous, prices, ws); // warm
+    assert(count_allocations([&] { run_incremental(today, previous, prices, ws); }) == 0 &&
+           "run_incremental must not allocate on a warm workspace");
+
+    // Deterministic reductions, inline and on a pool
+    ThreadPool pool(4);
+    deterministic_sum(prices, ws, &pool); // warm
+    assert(count_allocations([&] {
+               deterministic_sum(prices, ws);
+               deterministic_sum(prices, ws, &pool);
+               deterministic_dot(prices, prices, ws, &pool);
+           }) == 0 &&
+           "Reductions must not allocate on a warm workspace");
+
+    // Parameter grid sweep
+    GridAxes axes;
+    axes.S     = {90.0, 100.0, 110.0};
+    axes.sigma = {0.1, 0.2, 0.3, 0.4};
+    std::vector<double> grid(axes.size());
+    price_grid(contracts[0], axes, grid, ws, &pool); // warm
+    assert(count_allocations([&] { price_grid(contracts[0], axes, grid, ws, &pool); }) == 0 &&
+           "price_grid must not allocate on a warm workspace");
+
+    // Escrowed dividends
+    ContractBatch batch;
+    for (const auto& c : contracts) {
+        batch.push_back(c);
+    }
+    const std::vector<DividendSchedule> schedules{{{0.1, 0.35}, {0.5, 0.5}}};
+    const EscrowedDividends dividends(schedules, YieldCurve::flat(0.05));
+    const std::vector<std::uint32_t> underlying(batch.size(), 0);
+    price_batch_escrowed(batch, underlying, dividends, prices, ws); // warm
+    assert(count_allocations([&] {
+               price_batch_escrowed(batch, underlying, dividends, prices, ws);
+           }) == 0 &&
+           "price_batch_escrowed must not allocate on a warm workspace");
+}
+
+int main() {
+    test_batch_kernels_do_not_allocate();
+    test_warm_workspace_engines_do_not_allocate();
+    std::puts("All allocation tests passed.");
+    return 0;
+}
@@ -0,0 +1,78 @@
+"""
+Checks that ContractBatch refuses to resize while NumPy column views into it exist.
+
+Registered with CTest; run by hand with the module on PYTHONPATH:
+    PYTHONPATH=python python3 tests/test_batch_views.py
+"""
+
+import gc
+import sys
+
+import numpy as np
+
+import options_pricer as op
+
+MUTATORS = {
+    "append": lambda b: b.append(op.Contract(100.0, 100.0, 0.05, 0.2, 1.0, op.CALL)),
+    "extend": lambda b: b.extend(S=100.0, K=100.0, r=0.05, sigma=0.2, T=1.0, option_type=0),
+    "reserve": lambda b: b.reserve(1 << 16),
+    "clear": lambda b: b.clear(),
+}
+
+
+def make_batch(n: int) -> "op.ContractBatch":
+    batch = op.ContractBatch()
+    batch.extend(S=np.linspace(90.0, 110.0, n), K=100.0, r=0.05, sigma=0.2, T=1.0,
+                 option_type=np.arange(n) % 2)
+    return batch
+
+
+def assert_refused(batch, name):
+    try:
+        MUTATORS[name](batch)
+    except BufferError:
+        return
+    raise AssertionError(f"ContractBatch.{name} resized the batch under a live view")
+
+
+def test_views_block_resizing():
+    batch = make_batch(8)
+    spots = batch.S
+    for name in MUTATORS:
+        assert_refused(batch, name)
+    assert len(batch) == 8
+
+    # Slices keep the view's memory, so they keep the lease too.
+    tail = spots[4:]
+    del spots
+    gc.collect()
+    assert_refused(batch, "append")
+    del tail
+    gc.collect()
+
+    for name in MUTATORS:
+        MUTATORS[name](batch)
+
+
+def test_views_stay_writable_and_keep_batch_alive():
+    batch = make_batch(4)
+    types = batch.option_type
+    sigma = batch.sigma
+    sigma[:] = 0.3
+    assert all(batch[i].sigma == 0.3 for i in range(4))
+    del batch
+    gc.collect()
+    assert types.tolist() == [0, 1, 0, 1]
+    assert np.all(sigma == 0.3)
+
+
+def main() -> int:
+    for test in [test_views_block_resizing, test_views_stay_writable_and_keep_batch_alive]:
+        test()
+        print(f"{test.__name__}: ok")
+    print("All batch view tests passed.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
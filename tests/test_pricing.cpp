@@ -1,8 +1,37 @@
+#include "../src/arena.hpp"
 #include "../src/black_scholes.hpp"
+#include "../src/curves.hpp"
+#include "../src/dedup.hpp"
+#include "../src/dividends.hpp"
+#include "../src/eod_risk.hpp"
+#include "../src/grid.hpp"
+#include "../src/price_cache.hpp"
+#include "../src/pricing_graph.hpp"
+#include "../src/projection.hpp"
+#include "../src/reduction.hpp"
+#include "../src/risk_aggregator.hpp"
+#include "../src/shared_batch.hpp"
+#include "../src/sharded.hpp"
+#include "../src/strategy.hpp"
+#include "../src/vol_surface.hpp"
+#include "../src/warm_state.hpp"
 
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 // ---------------------------------------------------------------------------
 // Test 1: Call-put parity
@@ -47,11 +76,1140 @@ static void test_vega_symmetry() {
            "Vega must be equal for call and put with identical parameters");
 }
 
+// ---------------------------------------------------------------------------
+// Test 5: Strategy pricing deduplicates shared legs
+// A straddle and a call spread share the ATM call: 4 legs, 3 distinct contracts.
+// ---------------------------------------------------------------------------
+static void test_strategy_leg_dedup() {
+    const std::vector<Contract> contracts = {
+        {100.0, 100.0, 0.05, 0.20, 1.0, OptionType::CALL}, // 0: ATM call
+        {100.0, 100.0, 0.05, 0.20, 1.0, OptionType::PUT},  // 1: ATM put
+        {100.0, 110.0, 0.05, 0.20, 1.0, OptionType::CALL}, // 2: OTM call
+    };
+    const std::vector<Strategy> strategies = {
+        {{{0, 1.0}, {1, 1.0}}},  // long straddle
+        {{{0, 1.0}, {2, -1.0}}}, // bull call spread
+    };
+
+    const StrategyBatchResult res = price_strategies(contracts, strategies);
+    assert(res.total_legs == 4 && res.unique_legs == 3 && "Shared leg must be priced once");
+
+    const double atm_call = price_option(100.0, 100.0, 0.05, 0.20, 1.0, OptionType::CALL);
+    const double atm_put  = price_option(100.0, 100.0, 0.05, 0.20, 1.0, OptionType::PUT);
+    const double otm_call = price_option(100.0, 110.0, 0.05, 0.20, 1.0, OptionType::CALL);
+    assert(std::abs(res.values[0].price - (atm_call + atm_put)) < 1e-12 &&
+           "Straddle price must equal call + put");
+    assert(std::abs(res.values[1].price - (atm_call - otm_call)) < 1e-12 &&
+           "Spread price must equal long leg minus short leg");
+    const double straddle_delta =
+        compute_greeks(100.0, 100.0, 0.05, 0.20, 1.0, OptionType::CALL).delta +
+        compute_greeks(100.0, 100.0, 0.05, 0.20, 1.0, OptionType::PUT).delta;
+    assert(std::abs(res.values[0].greeks.delta - straddle_delta) < 1e-12 &&
+           "Straddle delta must equal call delta + put delta");
+}
+
+// ---------------------------------------------------------------------------
+// Test 6: Dedup stage matches price_batch exactly
+// Repeated contracts (including a -0.0 / +0.0 rate pair) collapse to one price.
+// ---------------------------------------------------------------------------
+static void test_batch_dedup() {
+    const Contract a{100.0, 100.0, 0.0, 0.20, 1.0, OptionType::CALL};
+    const Contract b{100.0, 100.0, -0.0, 0.20, 1.0, OptionType::CALL};
+    const Contract c{100.0, 100.0, 0.0, 0.20, 1.0, OptionType::PUT};
+    const std::vector<Contract> contracts = {a, c, b, a, c, a};
+
+    DedupArena arena;
+    DedupStats stats{};
+    const std::vector<double> deduped = price_batch_dedup(contracts, arena, &stats);
+    const std::vector<double> plain   = price_batch(contracts);
+
+    assert(stats.total == 6 && stats.unique == 2 && "Identical contracts must be priced once");
+    for (std::size_t i = 0; i < contracts.size(); ++i) {
+        assert(deduped[i] == plain[i] && "Dedup must scatter prices back in input order");
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Test 7: Result cache hits within a tick, misses outside it, and evicts when full
+// ---------------------------------------------------------------------------
+static void test_price_cache() {
+    CacheConfig config;
+    config.capacity     = 8; // a single bucket
+    config.tolerances.S = 0.01;
+    PricingCache cache(config);
+
+    const double p0 = cache.price(100.0, 100.0, 0.05, 0.20, 1.0, OptionType::CALL);
+    assert(p0 == price_option(100.0, 100.0, 0.05, 0.20, 1.0, OptionType::CALL) &&
+           "Miss must return the exact price");
+
+    const double p1 = cache.price(100.001, 100.0, 0.05, 0.20, 1.0, OptionType::CALL);
+    const Greeks g  = cache.greeks(100.0, 100.0, 0.05, 0.20, 1.0, OptionType::CALL);
+    assert(p1 == p0 && "Spot move within one tick must hit");
+    assert(g.delta == compute_greeks(100.0, 100.0, 0.05, 0.20, 1.0, OptionType::CALL).delta &&
+           "A price miss must also populate the Greeks");
+
+    cache.price(100.0, 100.0, 0.05, 0.20, 1.0, OptionType::PUT);
+    CacheStats s = cache.stats();
+    assert(s.hits == 2 && s.misses == 2 && s.evictions == 0 && "Unexpected hit/miss counts");
+
+    for (int i = 0; i < 16; ++i) {
+        cache.price(100.0 + i, 100.0, 0.05, 0.20, 1.0, OptionType::CALL);
+    }
+    s = cache.stats();
+    assert(s.evictions > 0 && "Overfilling a bounded cache must evict");
+
+    cache.clear();
+    cache.price(100.0, 100.0, 0.05, 0.20, 1.0, OptionType::CALL);
+    s = cache.stats();
+    assert(s.hits == 0 && s.misses == 1 && s.evictions == 0 &&
+           "Cleared entries must miss, and refilling them is not an eviction");
+
+    // Inputs that cannot be quantized must not share a key (llround has no defined
+    // result for them); they are computed directly every time.
+    const double big    = cache.price(1e30, 100.0, 0.05, 0.20, 1.0, OptionType::CALL);
+    const double bigger = cache.price(2e30, 100.0, 0.05, 0.20, 1.0, OptionType::CALL);
+    assert(big == price_option(1e30, 100.0, 0.05, 0.20, 1.0, OptionType::CALL) &&
+           bigger == price_option(2e30, 100.0, 0.05, 0.20, 1.0, OptionType::CALL) &&
+           "Out-of-range inputs must bypass the cache");
+    assert(std::isnan(cache.price(NAN, 100.0, 0.05, 0.20, 1.0, OptionType::CALL)));
+    assert(cache.price(100.0, 100.0, 0.05, 0.20, 1.0, OptionType::CALL) == p0 &&
+           "A NaN request must not be stored under a real quote's key");
+    s = cache.stats();
+    assert(s.hits == 1 && s.misses == 4 && "Bypassed requests count as misses");
+
+    // A step that can never quantize would make every request a silent miss.
+    const double bad_steps[] = {0.0, -0.01, std::nan(""), HUGE_VAL};
+    for (const double step : bad_steps) {
+        CacheConfig bad;
+        bad.tolerances.sigma = step;
+        bool rejected        = false;
+        try {
+            PricingCache unusable(bad);
+        } catch (const std::invalid_argument&) {
+            rejected = true;
+        }
+        assert(rejected && "Tolerances must be finite and positive");
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Test 8: Dependency graph only reprices contracts that read a changed input
+// ---------------------------------------------------------------------------
+static void test_pricing_graph_dirty_tracking() {
+    PricingGraph graph;
+    const auto spx  = graph.add_input(InputKind::SPOT, 100.0);
+    const auto ndx  = graph.add_input(InputKind::SPOT, 200.0);
+    const auto rate = graph.add_input(InputKind::RATE, 0.05);
+    const auto vol  = graph.add_input(InputKind::VOL, 0.20);
+
+    const auto a = graph.add_contract(spx, rate, vol, 100.0, 1.0, OptionType::CALL);
+    graph.add_contract(spx, rate, vol, 105.0, 1.0, OptionType::PUT);
+    graph.add_contract(ndx, rate, vol, 200.0, 1.0, OptionType::CALL);
+
+    graph.prices();
+    assert(graph.dirty_count() == 0 && graph.stats().last_recomputed == 3);
+
+    graph.set_input(spx, 101.0);
+    assert(graph.dirty_count() == 2 && "Only contracts on the moved spot are dirty");
+    graph.set_input(spx, 101.0);
+    assert(graph.dirty_count() == 2 && "Re-setting the same value must not re-dirty");
+
+    const double p = graph.price(a);
+    assert(p == price_option(101.0, 100.0, 0.05, 0.20, 1.0, OptionType::CALL));
+    assert(graph.stats().last_recomputed == 2 && graph.stats().total_recomputed == 5);
+
+    graph.set_input(rate, 0.04);
+    assert(graph.dirty_count() == 3 && "A rate move dirties every contract reading it");
+}
+
+// ---------------------------------------------------------------------------
+// Test 9: Incremental risk totals track trades and spot moves
+// ---------------------------------------------------------------------------
+static void test_risk_aggregator() {
+    RiskAggregator agg;
+    const auto spy = agg.add_underlying(100.0);
+    const auto qqq = agg.add_underlying(300.0);
+
+    agg.add_trade(spy, 10.0, 100.0, 0.05, 0.20, 1.0, OptionType::CALL);
+    const auto hedge = agg.add_trade(spy, -5.0, 95.0, 0.05, 0.25, 0.5, OptionType::PUT);
+    agg.add_trade(qqq, 1.0, 300.0, 0.05, 0.20, 1.0, OptionType::CALL);
+    agg.remove_trade(hedge);
+    assert(agg.trade_count(spy) == 1);
+
+    const double expected = 10.0 * price_option(100.0, 100.0, 0.05, 0.20, 1.0, OptionType::CALL);
+    assert(std::abs(agg.totals(spy).price - expected) < 1e-9 && "Removal must cancel the trade");
+
+    agg.move_spot(spy, 105.0);
+    const Greeks g = compute_greeks(105.0, 100.0, 0.05, 0.20, 1.0, OptionType::CALL);
+    assert(std::abs(agg.totals(spy).greeks.delta - 10.0 * g.delta) < 1e-9 &&
+           "Spot move must re-value the underlying's trades");
+    assert(std::abs(agg.totals(qqq).price -
+                    price_option(300.0, 300.0, 0.05, 0.20, 1.0, OptionType::CALL)) < 1e-9 &&
+           "Other underlyings must be untouched");
+}
+
+// ---------------------------------------------------------------------------
+// Test 10: End-of-day run reprices only changed or new rows
+// ---------------------------------------------------------------------------
+static void test_incremental_eod() {
+    const char* path = "test_eod_snapshot.bin";
+    std::remove(path);
+
+    ContractBatch day1;
+    day1.push_back({100.0, 100.0, 0.05, 0.20, 1.0, OptionType::CALL});
+    day1.push_back({100.0, 110.0, 0.05, 0.20, 1.0, OptionType::CALL});
+    day1.push_back({100.0, 90.0, 0.05, 0.20, 1.0, OptionType::PUT});
+    const IncrementalRunResult first = run_eod(day1, path);
+    assert(first.recomputed == 3 && "Without a snapshot every row is priced");
+
+    ContractBatch day2 = day1;
+    day2.sigma[1]      = 0.25;                                      // vol move on one row
+    day2.push_back({100.0, 95.0, 0.05, 0.20, 0.5, OptionType::PUT}); // new position
+    const IncrementalRunResult second = run_eod(day2, path);
+    assert(second.recomputed == 2 && "Only the changed and the new row are repriced");
+
+    const Column<double> full = price_batch(day2);
+    for (std::size_t i = 0; i < full.size(); ++i) {
+        assert(second.prices[i] == full[i] && "Incremental result must match a full run");
+    }
+    assert(load_snapshot(path).prices == full && "Snapshot must hold today's results");
+
+    // A caller-built snapshot with fewer prices than inputs must not be read past its end.
+    RiskSnapshot short_prices = load_snapshot(path);
+    short_prices.prices.resize(1);
+    bool mismatch_rejected = false;
+    try {
+        run_incremental(day2, short_prices);
+    } catch (const std::invalid_argument&) {
+        mismatch_rejected = true;
+    }
+    assert(mismatch_rejected && "Snapshot prices must match its inputs in length");
+
+    // A save that cannot complete (here: the temporary file cannot be created) must leave
+    // yesterday's snapshot readable.
+    const std::string tmp = std::string(path) + ".tmp";
+    mkdir(tmp.c_str(), 0700);
+    ContractBatch day3 = day2;
+    day3.S[0]          = 101.0;
+    bool save_failed   = false;
+    try {
+        run_eod(day3, path);
+    } catch (const std::runtime_error&) {
+        save_failed = true;
+    }
+    rmdir(tmp.c_str());
+    assert(save_failed && "A failed snapshot save must be reported");
+    assert(load_snapshot(path).prices == full && "A failed save must keep the old snapshot");
+
+    // A corrupt row count must be caught against the file size, not by allocating it.
+    {
+        std::FILE* f             = std::fopen(path, "r+b");
+        const std::uint64_t rows = std::uint64_t{1} << 60;
+        std::fseek(f, 16, SEEK_SET); // magic, version, reserved
+        std::fwrite(&rows, sizeof rows, 1, f);
+        std::fclose(f);
+    }
+    bool rejected = false;
+    try {
+        load_snapshot(path);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert(rejected && "A row count larger than the file must be rejected");
+    std::remove(path);
+}
+
+// ---------------------------------------------------------------------------
+// Test 11: Deterministic reductions are bit-identical for any thread count
+// ---------------------------------------------------------------------------
+static void test_deterministic_reduction() {
+    // Values spanning many magnitudes so a different summation order would round differently.
+    const std::size_t n = 3 * REDUCTION_BLOCK + 123;
+    std::vector<double> values(n), weights(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        values[i]  = std::sin(static_cast<double>(i)) * std::pow(10.0, static_cast<double>(i % 9));
+        weights[i] = (i % 3 == 0) ? -1.5 : 2.0;
+    }
+
+    const double serial     = deterministic_sum(values.data(), n);
+    const double serial_dot = deterministic_dot(weights.data(), values.data(), n);
+    for (const unsigned threads : {1u, 2u, 3u, 8u}) {
+        ThreadPool pool(threads);
+        assert(deterministic_sum(values.data(), n, &pool) == serial &&
+               "Sum must not depend on the thread count");
+        assert(deterministic_dot(weights.data(), values.data(), n, &pool) == serial_dot &&
+               "Dot product must not depend on the thread count");
+    }
+
+    double naive = 0.0;
+    for (const double v : values) {
+        naive += v;
+    }
+    assert(std::abs(serial - naive) <= 1e-9 * std::abs(naive) && "Sum must be accurate");
+}
+
+// ---------------------------------------------------------------------------
+// Test 12: Arena scopes release per-valuation memory; the pool recycles blocks
+// ---------------------------------------------------------------------------
+static void test_arena_and_pool() {
+    MonotonicArena arena(4096);
+    {
+        ArenaScope valuation(arena);
+        auto* grid = arena.allocate_array<double>(1000);
+        assert(reinterpret_cast<std::uintptr_t>(grid) % alignof(double) == 0);
+        arena.allocate(3 * HUGE_PAGE_SIZE, 64); // large request goes to huge-page backing
+        assert(arena.stats().bytes_in_use >= 3 * HUGE_PAGE_SIZE);
+    }
+    const ArenaStats after = arena.stats();
+    assert(after.bytes_in_use == 0 && after.resets == 1 && "Scope must rewind the arena");
+    assert(after.bytes_reserved >= 3 * HUGE_PAGE_SIZE && "Chunks stay mapped for reuse");
+
+    const std::size_t reserved = after.bytes_reserved;
+    {
+        ArenaScope again(arena);
+        arena.allocate(3 * HUGE_PAGE_SIZE, 64);
+    }
+    assert(arena.stats().bytes_reserved == reserved && "A repeat valuation must reuse chunks");
+
+    SizeClassPool pool;
+    void* a = pool.allocate(40); // 64-byte class
+    pool.deallocate(a, 40);
+    void* b = pool.allocate(64);
+    assert(a == b && "Freed block must be recycled within its size class");
+    pool.deallocate(b, 64);
+    assert(pool.stats().bytes_in_use == 0 && pool.stats().allocations == 2);
+}
+
+// ---------------------------------------------------------------------------
+// Test 13: Streaming kernel matches the plain kernel bit for bit, whatever the
+// output alignment (scalar head, full cache-line blocks, scalar tail)
+// ---------------------------------------------------------------------------
+static void test_streaming_batch_matches_plain() {
+    ContractBatch batch;
+    for (std::size_t i = 0; i < 1003; ++i) {
+        const OptionType type = (i % 3 == 0) ? OptionType::PUT : OptionType::CALL;
+        batch.push_back({90.0 + static_cast<double>(i % 21), 100.0, 0.03, 0.15 + 0.01 * (i % 7),
+                         0.1 + 0.05 * static_cast<double>(i % 11), type});
+    }
+    std::vector<double> plain(batch.size());
+    price_batch_plain(batch, plain);
+
+    std::vector<double> storage(batch.size() + 1);
+    for (const std::size_t offset : {0, 1}) { // shift the output off cache-line alignment
+        Span<double> out(storage.data() + offset, batch.size());
+        price_batch_streaming(batch, out);
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            assert(out[i] == plain[i] && "Streaming kernel must match the plain kernel");
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Test 14: Guarded kernel returns intrinsic value for degenerate rows, stays
+// finite far from the money, flags NaN inputs, and matches the plain pricer elsewhere
+// ---------------------------------------------------------------------------
+static void test_guarded_degenerate_rows() {
+    const double r = 0.05;
+    ContractBatch batch;
+    batch.push_back({110.0, 100.0, r, 0.20, 0.0, OptionType::CALL});  // expired ITM call
+    batch.push_back({110.0, 100.0, r, 0.20, -0.5, OptionType::PUT});  // past expiry OTM put
+    batch.push_back({90.0, 100.0, r, 0.0, 1.0, OptionType::PUT});     // zero vol
+    batch.push_back({100.0, 1e6, r, 0.10, 0.01, OptionType::CALL});   // absurdly far OTM
+    batch.push_back({100.0, 95.0, r, 0.25, 0.75, OptionType::PUT});   // well-formed
+    std::vector<double> prices(batch.size());
+    price_batch_guarded(batch, prices);
+
+    for (const double p : prices) {
+        assert(std::isfinite(p) && p >= 0.0 && "Guarded prices must be finite");
+    }
+    assert(std::abs(prices[0] - 10.0) < 1e-12 && "Expired call pays S - K");
+    assert(prices[1] == 0.0 && "Expired OTM put is worthless");
+    assert(std::abs(prices[2] - (100.0 * std::exp(-r) - 90.0)) < 1e-12 &&
+           "Zero-vol put is the discounted forward intrinsic");
+    assert(prices[3] == 0.0 && "Clamped far-OTM call rounds to zero");
+    const double ref = price_option(100.0, 95.0, r, 0.25, 0.75, OptionType::PUT);
+    assert(std::abs(prices[4] - ref) < 1e-12 && "Well-formed rows match price_option");
+
+    // Missing market data must not come out as a plausible price.
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    ContractBatch missing;
+    missing.push_back({nan, 100.0, r, 0.20, 1.0, OptionType::CALL});
+    missing.push_back({100.0, nan, r, 0.20, 1.0, OptionType::PUT});
+    missing.push_back({100.0, 100.0, nan, 0.20, 1.0, OptionType::CALL});
+    missing.push_back({120.0, 100.0, r, nan, 1.0, OptionType::CALL});  // ITM: intrinsic > 0
+    missing.push_back({120.0, 100.0, r, 0.20, nan, OptionType::CALL});
+    std::vector<double> flagged(missing.size());
+    price_batch_guarded(missing, flagged);
+    for (const double p : flagged) {
+        assert(std::isnan(p) && "NaN inputs must price to NaN");
+    }
+    assert(std::isnan(price_option_guarded(120.0, 100.0, r, 0.20, nan, OptionType::CALL)));
+}
+
+// ---------------------------------------------------------------------------
+// Test 15: Time-decay ladder starts at today's price, decays to intrinsic past
+// expiry, and the book totals equal the quantity-weighted ladder columns
+// ---------------------------------------------------------------------------
+static void test_time_decay_ladder() {
+    ContractBatch batch;
+    batch.push_back({100.0, 100.0, 0.05, 0.20, 30.0 / 365.0, OptionType::CALL});
+    batch.push_back({100.0, 110.0, 0.05, 0.30, 0.5, OptionType::PUT});
+    const std::vector<double> days = {0.0, 7.0, 29.0, 45.0};
+    const DecayLadder ladder       = project_time_decay(batch, days);
+    assert(ladder.contracts == 2 && ladder.horizons == 4);
+
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        const double today = price_option(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i],
+                                          batch.T[i], batch.option_type[i]);
+        assert(std::abs(ladder.at(i, 0) - today) < 1e-12 && "Horizon 0 is today's price");
+    }
+    assert(ladder.at(0, 0) > ladder.at(0, 1) && ladder.at(0, 1) > ladder.at(0, 2) &&
+           "ATM call loses value as expiry approaches");
+    assert(ladder.at(0, 3) == 0.0 && "ATM call past expiry is worth intrinsic (zero)");
+
+    const std::vector<double> qty    = {10.0, -4.0};
+    const std::vector<double> totals = project_book_decay(batch, qty, days);
+    for (std::size_t j = 0; j < days.size(); ++j) {
+        const double expected = qty[0] * ladder.at(0, j) + qty[1] * ladder.at(1, j);
+        assert(std::abs(totals[j] - expected) < 1e-9 && "Book totals must match the ladder");
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Test 16: Grid sweeps match pointwise pricing, in row-major S, K, r, sigma, T
+// order, and do not depend on the thread pool
+// ---------------------------------------------------------------------------
+static void test_parameter_grid() {
+    const Contract base{100.0, 100.0, 0.03, 0.25, 0.5, OptionType::PUT};
+    GridAxes axes;
+    axes.S     = {80.0, 100.0, 120.0};
+    axes.sigma = {0.1, 0.2, 0.4, 0.8};
+    axes.T     = {0.25, 1.0};
+    assert(axes.size() == 24 && axes.shape()[1] == 1 && "Fixed axes have extent 1");
+
+    const std::vector<double> prices    = price_grid(base, axes);
+    const std::vector<Valuation> values = greeks_grid(base, axes);
+    for (std::size_t s = 0; s < 3; ++s) {
+        for (std::size_t v = 0; v < 4; ++v) {
+            for (std::size_t t = 0; t < 2; ++t) {
+                const std::size_t i = (s * 4 + v) * 2 + t;
+                const double ref    = price_option(axes.S[s], base.K, base.r, axes.sigma[v],
+                                                   axes.T[t], base.option_type);
+                const Greeks g      = compute_greeks(axes.S[s], base.K, base.r, axes.sigma[v],
+                                                     axes.T[t], base.option_type);
+                assert(std::abs(prices[i] - ref) < 1e-12 && "Grid price must match");
+                assert(std::abs(values[i].price - ref) < 1e-12);
+                assert(std::abs(values[i].greeks.delta - g.delta) < 1e-12 &&
+                       std::abs(values[i].greeks.vega - g.vega) < 1e-12 &&
+                       "Grid Greeks must match compute_greeks");
+            }
+        }
+    }
+
+    GridAxes big;
+    for (int i = 0; i < 200; ++i) {
+        big.S.push_back(50.0 + i);
+        big.K.push_back(60.0 + 0.5 * i);
+    }
+    ThreadPool pool(4);
+    assert(price_grid(base, big, &pool) == price_grid(base, big) &&
+           "Pool must not change grid results");
+}
+
+// ---------------------------------------------------------------------------
+// Test 17: Concurrent callers share one pool (a busy pool runs tasks inline) and
+// may clear a cache while other threads read it
+// ---------------------------------------------------------------------------
+static void test_shared_pool_and_cache_clear() {
+    ThreadPool pool(4);
+    PricingCache cache;
+    std::atomic<bool> bad{false};
+    const auto caller = [&](int id) {
+        std::vector<std::size_t> hits(1000);
+        for (int round = 0; round < 20; ++round) {
+            pool.parallel_for(hits.size(), [&](std::size_t i) { ++hits[i]; });
+            for (int q = 0; q < 50; ++q) {
+                const double S = 90.0 + q;
+                const double p = cache.price(S, 100.0, 0.05, 0.2, 1.0, OptionType::CALL);
+                if (p != price_option(S, 100.0, 0.05, 0.2, 1.0, OptionType::CALL)) {
+                    bad = true;
+                }
+            }
+            if (id == 0) {
+                cache.clear();
+            }
+        }
+        for (const std::size_t h : hits) {
+            if (h != 20) {
+                bad = true; // every task must run exactly once per parallel_for
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back(caller, t);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    assert(!bad && "Shared pool and cache must stay correct under concurrent callers");
+}
+
+// ---------------------------------------------------------------------------
+// Test 18: A forked worker attaches a shared batch by handle and prices its half
+// in place; the result buffer matches price_batch on the original batch
+// ---------------------------------------------------------------------------
+static void test_shared_batch_across_processes() {
+    ContractBatch batch;
+    for (int i = 0; i < 1001; ++i) {
+        batch.push_back({90.0 + i % 20, 80.0 + i % 40, 0.05, 0.1 + 0.01 * (i % 30),
+                         0.25 + 0.01 * (i % 50), i % 2 ? OptionType::PUT : OptionType::CALL});
+    }
+    const Column<double> expected = price_batch(batch);
+
+    const std::string name = "/opx_test_" + std::to_string(getpid());
+    SharedBatch shared     = SharedBatch::create(name, batch);
+    assert(shared.owner() && shared.size() == batch.size());
+    const SharedBatchHandle handle = shared.handle();
+    const std::size_t half         = 504; // multiple of 8: the halves share no price line
+
+    const pid_t pid = fork();
+    if (pid == 0) {
+        int status = 0;
+        try {
+            const SharedBatch worker = SharedBatch::attach(handle);
+            status                   = worker.owner() ? 1 : 0;
+            worker.price_rows(half, worker.size());
+        } catch (...) {
+            status = 1;
+        }
+        _exit(status);
+    }
+    assert(pid > 0);
+    shared.price_rows(0, half);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0 && "Worker must attach and price");
+
+    const Span<double> prices = shared.prices();
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        assert(prices[i] == expected[i] && "Shared result buffer must match price_batch");
+    }
+
+    bool threw = false;
+    try {
+        SharedBatch::attach(SharedBatchHandle{name, batch.size() + 1});
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw && "Attach must reject a handle with the wrong row count");
+
+    shared.unlink();
+    threw = false;
+    try {
+        SharedBatch::attach(handle);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw && "Attach must fail once the name is unlinked");
+    assert(shared.prices()[0] == expected[0] && "Mapping must outlive the name");
+}
+
+// ---------------------------------------------------------------------------
+// Test 19: Native IV solve round-trips BS prices, and the chain-to-surface pipeline
+// filters, merges OTM sides and inner-joins strikes across expiries; mismatched sides
+// are rejected before the pool sees them
+// ---------------------------------------------------------------------------
+static void test_iv_surface() {
+    for (const double sigma : {0.05, 0.2, 0.8, 2.5}) {
+        for (const double K : {60.0, 100.0, 140.0}) {
+            for (const OptionType type : {OptionType::CALL, OptionType::PUT}) {
+                const double p    = price_option(100.0, K, 0.05, sigma, 0.5, type);
+                const double iv   = implied_vol(p, 100.0, K, 0.05, 0.5, type);
+                const double vega = compute_greeks(100.0, K, 0.05, sigma, 0.5, type).vega;
+                assert(std::fabs(price_option(100.0, K, 0.05, iv, 0.5, type) - p) <= 1e-6 &&
+                       "IV must reprice to the input");
+                // Where vega vanishes any vol reprices within tolerance; elsewhere it is unique.
+                assert((vega < 1e-3 || std::fabs(iv - sigma) < 1e-6) && "IV must round-trip");
+            }
+        }
+    }
+    assert(std::isnan(implied_vol(101.0, 100.0, 100.0, 0.05, 0.5, OptionType::CALL)) &&
+           "A call above spot has no implied vol");
+
+    const double spot = 100.0;
+    const auto smile_vol = [](double K, double T) {
+        return 0.2 + 0.3 * std::fabs(K - 100.0) / 100.0 + 0.01 * T;
+    };
+
+    // Puts are quoted 5 vol points above calls so the merge side is visible.
+    // Three expiries quoting strikes 70..130 step 5 (80..120 inside the band); expiry 1
+    // lacks 95, expiry 2 has no bids at all, and every 115 quote is too wide to use.
+    const double Ts[] = {0.5, 0.25, 1.0};
+    std::vector<std::vector<double>> cols(3 * 6);
+    std::vector<ExpiryChain> chains(3);
+    for (int e = 0; e < 3; ++e) {
+        for (double K = 70.0; K <= 130.0; K += 5.0) {
+            if (e == 1 && K == 95.0) {
+                continue;
+            }
+            for (int side = 0; side < 2; ++side) {
+                const OptionType type = side == 0 ? OptionType::CALL : OptionType::PUT;
+                const double vol  = smile_vol(K, Ts[e]) + (side == 1 ? 0.05 : 0.0);
+                const double mid  = price_option(spot, K, 0.05, vol, Ts[e], type);
+                const double half = K == 115.0 ? 0.6 * mid : 0.01 * mid;
+                cols[e * 6 + side * 3 + 0].push_back(K);
+                cols[e * 6 + side * 3 + 1].push_back(e == 2 ? 0.0 : mid - half);
+                cols[e * 6 + side * 3 + 2].push_back(mid + half);
+            }
+        }
+        chains[e].T     = Ts[e];
+        chains[e].calls = {cols[e * 6 + 0], cols[e * 6 + 1], cols[e * 6 + 2]};
+        chains[e].puts  = {cols[e * 6 + 3], cols[e * 6 + 4], cols[e * 6 + 5]};
+    }
+
+    ThreadPool pool(3);
+    const IvSurface serial   = build_iv_surface(chains, spot);
+    const IvSurface parallel = build_iv_surface(chains, spot, SurfaceOptions{}, &pool);
+    assert(serial.iv == parallel.iv && serial.strikes == parallel.strikes);
+
+    assert(serial.quoted[0] == 8 && serial.quoted[1] == 7 && serial.quoted[2] == 0);
+    assert(serial.expiry.size() == 2 && serial.expiry[0] == 1 && serial.expiry[1] == 0 &&
+           "Rows must be the liquid expiries sorted by T");
+    assert(serial.strikes.size() == 7 && serial.strikes.front() == 80.0 &&
+           serial.strikes.back() == 120.0 &&
+           "Strikes must be the band-filtered intersection across expiries");
+    for (std::size_t row = 0; row < serial.T.size(); ++row) {
+        for (std::size_t col = 0; col < serial.strikes.size(); ++col) {
+            assert(serial.strikes[col] != 95.0 && serial.strikes[col] != 115.0);
+            const double K    = serial.strikes[col];
+            const double want = smile_vol(K, serial.T[row]) + (K <= spot ? 0.05 : 0.0);
+            assert(std::fabs(serial.at(row, col) - want) < 1e-4 &&
+                   "Surface must take puts at or below spot and calls above it");
+        }
+    }
+
+    // A short bid column on the last expiry's puts is rejected up front, pool or not.
+    chains[2].puts.bid = chains[2].puts.bid.subspan(0, chains[2].puts.bid.size() - 1);
+    for (ThreadPool* p : {static_cast<ThreadPool*>(nullptr), &pool}) {
+        bool threw = false;
+        try {
+            build_iv_surface(chains, spot, SurfaceOptions{}, p);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        assert(threw && "Mismatched side lengths must throw std::invalid_argument");
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Test 20: Sharded pricing across worker processes merges in row order and survives
+// a worker dying mid-batch or no longer reading its socket
+// ---------------------------------------------------------------------------
+static void test_sharded_coordinator() {
+    ContractBatch batch;
+    for (int i = 0; i < 10'000; ++i) {
+        batch.push_back({80.0 + i % 41, 70.0 + i % 61, 0.05, 0.1 + 0.01 * (i % 40),
+                         0.1 + 0.01 * (i % 190), i % 3 ? OptionType::PUT : OptionType::CALL});
+    }
+    const Column<double> expected = price_batch(batch);
+
+    ShardOptions options;
+    options.workers           = 3;
+    options.shard_rows        = 1'000;
+    options.fail_after_shards = 1; // first worker dies on its second shard
+    ShardCoordinator coordinator(options);
+
+    for (int run = 0; run < 2; ++run) {
+        Column<double> prices(batch.size(), -1.0);
+        coordinator.price_batch(batch, prices);
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            assert(prices[i] == expected[i] && "Sharded prices must match price_batch in order");
+        }
+    }
+    const ShardStats& stats = coordinator.stats();
+    assert(stats.batches == 2 && stats.shards == 20);
+    assert(stats.worker_failures == 1 && stats.reassigned == 1 && stats.respawns == 1 &&
+           "The dead worker's shard must be reassigned and the worker replaced");
+
+    // A worker that stops reading must not block the coordinator's send: a 50,000-row
+    // shard (about 2 MB) overfills the socket buffer, and the deadline reclaims it.
+    ContractBatch large;
+    for (int copy = 0; copy < 10; ++copy) {
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            large.push_back(batch.row(i));
+        }
+    }
+    ShardOptions stall;
+    stall.workers            = 2;
+    stall.shard_rows         = 50'000;
+    stall.shard_timeout_ms   = 200;
+    stall.stall_after_shards = 0;
+    ShardCoordinator stalled(stall);
+    Column<double> prices(large.size(), -1.0);
+    stalled.price_batch(large, prices);
+    for (std::size_t i = 0; i < large.size(); ++i) {
+        assert(prices[i] == expected[i % batch.size()] &&
+               "Shards of a stalled worker must be priced elsewhere");
+    }
+    assert(stalled.stats().worker_failures == 1 && stalled.stats().reassigned == 1);
+
+    // A shard out of attempts fails the batch, but the dead worker still counts and is
+    // replaced, so the coordinator keeps working.
+    ShardOptions strict;
+    strict.workers           = 1;
+    strict.shard_rows        = 1'000;
+    strict.max_attempts      = 1;
+    strict.fail_after_shards = 0;
+    ShardCoordinator once(strict);
+    Column<double> retried(batch.size(), -1.0);
+    bool batch_failed = false;
+    try {
+        once.price_batch(batch, retried);
+    } catch (const std::runtime_error& e) {
+        batch_failed = std::strstr(e.what(), "shard 0 failed") != nullptr;
+    }
+    assert(batch_failed && "The exhausted shard's error must be the one reported");
+    assert(once.stats().worker_failures == 1 && once.stats().respawns == 1 &&
+           once.stats().reassigned == 0);
+    once.price_batch(batch, retried);
+    assert(retried == expected && "The replacement worker must serve the next batch");
+}
+
+// ---------------------------------------------------------------------------
+// Test 21: A busy-poll (SPIN) pool runs every task exactly once per parallel_for,
+// back to back and with concurrent callers, and shuts down cleanly
+// ---------------------------------------------------------------------------
+static void test_spin_pool() {
+    PoolOptions options;
+    options.threads = 3;
+    options.wait    = PoolWait::SPIN;
+    options.pin     = true;
+    ThreadPool pool(options);
+    assert(pool.size() == 3);
+    // Spinning needs a core per thread; smaller machines fall back to blocking waits.
+    const bool spins = std::thread::hardware_concurrency() >= 3;
+    assert(pool.wait_mode() == (spins ? PoolWait::SPIN : PoolWait::BLOCK));
+
+    std::atomic<bool> bad{false};
+    const auto caller = [&] {
+        std::vector<std::atomic<int>> hits(37);
+        for (int round = 0; round < 500; ++round) {
+            for (auto& h : hits) {
+                h.store(0, std::memory_order_relaxed);
+            }
+            pool.parallel_for(hits.size(), [&](std::size_t i) { hits[i].fetch_add(1); });
+            for (auto& h : hits) {
+                if (h.load() != 1) {
+                    bad = true;
+                }
+            }
+        }
+    };
+    std::thread other(caller);
+    caller();
+    other.join();
+    assert(!bad && "SPIN pool must run each task exactly once");
+}
+
+// ---------------------------------------------------------------------------
+// Test 22: Warm state round-trips through a mapped file: book, results, surfaces and
+// quote cache come back bit-identical, and damaged files are rejected
+// ---------------------------------------------------------------------------
+static void test_warm_state() {
+    const char* path = "test_warm_state.bin";
+    std::remove(path);
+
+    ContractBatch book;
+    for (int i = 0; i < 100; ++i) {
+        book.push_back({100.0, 80.0 + 0.4 * i, 0.05, 0.15 + 0.001 * i, 0.25 + 0.01 * i,
+                        i % 2 == 0 ? OptionType::CALL : OptionType::PUT});
+    }
+    Column<double> prices(book.size());
+    std::vector<Greeks> greeks(book.size());
+    price_batch(book, prices);
+    greeks_batch(book, greeks);
+
+    NamedSurface spy{"SPY", {}};
+    spy.surface.strikes = {95.0, 100.0, 105.0};
+    spy.surface.T       = {0.25, 0.5};
+    spy.surface.expiry  = {1, 0};
+    spy.surface.quoted  = {4, 3, 0};
+    spy.surface.iv      = {0.22, 0.20, 0.19, 0.21, 0.195, 0.185};
+    const std::vector<NamedSurface> surfaces{spy};
+
+    PricingCache cache;
+    for (std::size_t i = 0; i < book.size(); ++i) {
+        const Contract c = book.row(i);
+        cache.price(c.S, c.K, c.r, c.sigma, c.T, c.option_type);
+    }
+
+    WarmState state;
+    state.contracts = book;
+    state.prices    = prices;
+    state.greeks    = greeks;
+    state.surfaces  = surfaces;
+    state.cache     = &cache;
+    save_warm_state(path, state);
+
+    const WarmStateFile warm(path);
+    assert(warm.size() == book.size());
+    const BatchView v = warm.contracts();
+    for (std::size_t i = 0; i < book.size(); ++i) {
+        assert(v.S[i] == book.S[i] && v.K[i] == book.K[i] && v.r[i] == book.r[i] &&
+               v.sigma[i] == book.sigma[i] && v.T[i] == book.T[i] &&
+               v.option_type[i] == book.option_type[i] && "Book must restore bit-identical");
+        assert(warm.prices()[i] == prices[i] && warm.greeks()[i].vega == greeks[i].vega);
+    }
+    Column<double> repriced(v.size());
+    price_batch(v, repriced); // mapped columns feed the kernels directly
+    assert(repriced == prices);
+
+    assert(warm.surface_count() == 1 && warm.surface_name(0) == "SPY");
+    assert(warm.find_surface("SPY") == 0 && warm.find_surface("QQQ") == 1);
+    const IvSurface restored = warm.surface(0);
+    assert(restored.strikes == spy.surface.strikes && restored.T == spy.surface.T &&
+           restored.expiry == spy.surface.expiry && restored.quoted == spy.surface.quoted &&
+           restored.iv == spy.surface.iv && "Surface must restore bit-identical");
+
+    PricingCache fresh;
+    assert(warm.cache_entries() == book.size());
+    assert(warm.warm(fresh) == book.size());
+    for (std::size_t i = 0; i < book.size(); ++i) {
+        const Contract c = book.row(i);
+        assert(fresh.price(c.S, c.K, c.r, c.sigma, c.T, c.option_type) == prices[i]);
+    }
+    assert(fresh.stats().hits == book.size() && fresh.stats().misses == 0 &&
+           "A warmed cache must serve the saved quotes without recomputing");
+
+    CacheConfig coarse;
+    coarse.tolerances.S = 0.01;
+    PricingCache other(coarse);
+    bool rejected = false;
+    try {
+        warm.warm(other);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    assert(rejected && "Entries keyed under other tolerances must not be loaded");
+
+    // Dimensions whose byte sizes wrap around size_t must be rejected, not mapped.
+    {
+        std::FILE* f = std::fopen(path, "rb");
+        std::vector<char> bytes(1 << 16);
+        bytes.resize(std::fread(bytes.data(), 1, bytes.size(), f));
+        std::fclose(f);
+        const auto field = [&](std::size_t offset) {
+            std::uint64_t v = 0;
+            std::memcpy(&v, bytes.data() + offset, sizeof v);
+            return v;
+        };
+        // FileHeader is 64 bytes with the section count at 12, rows at 16; the table
+        // follows, entries {u32 kind, u32, u64 offset, u64 bytes}.
+        std::uint32_t sections = 0;
+        std::memcpy(&sections, bytes.data() + 12, sizeof sections);
+        std::size_t surface = 0;
+        for (std::size_t e = 64; e < 64 + 24 * std::size_t{sections}; e += 24) {
+            if (static_cast<std::uint32_t>(field(e)) == 8) { // Section::SURFACE
+                surface = field(e + 8);
+            }
+        }
+        assert(surface != 0);
+        const char* bad = "test_warm_state_bad.bin";
+        const auto rejects = [&](std::size_t offset, std::uint64_t value) {
+            std::vector<char> damaged = bytes;
+            std::memcpy(damaged.data() + offset, &value, sizeof value);
+            std::FILE* out = std::fopen(bad, "wb");
+            std::fwrite(damaged.data(), 1, damaged.size(), out);
+            std::fclose(out);
+            bool threw = false;
+            try {
+                WarmStateFile damaged_file(bad);
+            } catch (const std::runtime_error&) {
+                threw = true;
+            }
+            std::remove(bad);
+            return threw;
+        };
+        const std::uint64_t wraps = std::uint64_t{1} << 61; // 2^61 * 8 bytes == 0 mod 2^64
+        assert(rejects(16, wraps) && "A row count overflowing the columns must be rejected");
+        assert(rejects(surface, wraps) && rejects(surface + 8, wraps) &&
+               "Surface dimensions overflowing size_t must be rejected");
+    }
+
+    // Truncate the file: opening must fail rather than map past the end.
+    {
+        std::FILE* f = std::fopen(path, "rb");
+        std::vector<char> bytes(1 << 16);
+        bytes.resize(std::fread(bytes.data(), 1, bytes.size(), f));
+        std::fclose(f);
+        f = std::fopen(path, "wb");
+        std::fwrite(bytes.data(), 1, bytes.size() / 2, f);
+        std::fclose(f);
+    }
+    rejected = false;
+    try {
+        WarmStateFile truncated(path);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert(rejected && "A truncated warm state must be rejected");
+    std::remove(path);
+}
+
+// ---------------------------------------------------------------------------
+// Test 23: Yield curves interpolate log-linearly in discount factors, batch lookups match
+// scalar ones in any row order, and curve pricing reduces to price_option
+// ---------------------------------------------------------------------------
+static void test_yield_curves() {
+    const YieldCurve curve({0.5, 1.0, 2.0}, {0.04, 0.045, 0.05});
+    assert(std::abs(curve.discount(1.0) - std::exp(-0.045)) < 1e-15 &&
+           "Pillars must be reproduced exactly");
+    assert(std::abs(curve.discount(1.5) - std::sqrt(std::exp(-0.045) * std::exp(-0.10))) <
+               1e-15 &&
+           "Between pillars the discount factor is the geometric interpolation");
+    assert(std::abs(curve.zero_rate(0.25) - 0.04) < 1e-15 && curve.zero_rate(0.0) == 0.04 &&
+           "The first zero rate holds back to t = 0");
+    const double last_forward = (0.10 - 0.045) / 1.0;
+    assert(std::abs(curve.discount(3.0) - std::exp(-0.10 - last_forward)) < 1e-15 &&
+           "The last forward rate is extended past the last pillar");
+
+    const YieldCurve same = YieldCurve::from_discount_factors(
+        {0.5, 1.0, 2.0}, {std::exp(-0.02), std::exp(-0.045), std::exp(-0.10)});
+    assert(std::abs(same.zero_rate(1.7) - curve.zero_rate(1.7)) < 1e-15);
+
+    // Shuffled maturities exercise both the segment hint and the binary search.
+    const std::vector<double> T{2.5, 0.1, 1.2, 1.3, 0.0, 0.75, 2.0, 0.5, 1.9, 0.3};
+    std::vector<double> df(T.size());
+    std::vector<double> zero(T.size());
+    curve.discount(T, df);
+    curve.zero_rate(T, zero);
+    for (std::size_t i = 0; i < T.size(); ++i) {
+        assert(df[i] == curve.discount(T[i]) && zero[i] == curve.zero_rate(T[i]) &&
+               "Batch lookups must match scalar ones");
+    }
+
+    bool rejected = false;
+    try {
+        YieldCurve({1.0, 0.5}, {0.05, 0.05});
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    assert(rejected && "Unsorted pillars must be rejected");
+
+    ContractBatch book;
+    for (std::size_t i = 0; i < T.size(); ++i) {
+        if (T[i] > 0.0) {
+            book.push_back({100.0, 90.0 + 2.0 * i, 0.0, 0.2, T[i],
+                            i % 2 == 0 ? OptionType::CALL : OptionType::PUT});
+        }
+    }
+    const DividendCurve dividends({1.0, 3.0}, {0.013, 0.015});
+    std::vector<double> prices(book.size());
+    price_batch_curves(book, curve, dividends, prices);
+    for (std::size_t i = 0; i < book.size(); ++i) {
+        const Contract c = book.row(i);
+        const double q   = dividends.zero_rate(c.T);
+        const double ref = price_option(c.S * std::exp(-q * c.T), c.K, curve.zero_rate(c.T),
+                                        c.sigma, c.T, c.option_type);
+        assert(std::abs(prices[i] - ref) < 1e-10 &&
+               "Curve pricing must equal BS on the dividend-adjusted spot and zero rate");
+    }
+
+    // Put-call parity on the forward: C - P = S·Dq - K·D.
+    ContractBatch pair;
+    pair.push_back({100.0, 105.0, 0.0, 0.3, 1.4, OptionType::CALL});
+    pair.push_back({100.0, 105.0, 0.0, 0.3, 1.4, OptionType::PUT});
+    std::vector<double> cp(2);
+    price_batch_curves(pair, curve, dividends, cp);
+    const double parity = 100.0 * dividends.discount(1.4) - 105.0 * curve.discount(1.4);
+    assert(std::abs(cp[0] - cp[1] - parity) < 1e-10 && "Curve prices must satisfy parity");
+}
+
+// ---------------------------------------------------------------------------
+// Test 24: Escrowed cash dividends lower the spot by the PV of dividends going ex before
+// expiry, per underlying, and keep put-call parity
+// ---------------------------------------------------------------------------
+static void test_escrowed_dividends() {
+    const double r = 0.05;
+    // Underlying 0: quarterly 0.45 (one already paid), listed out of order; 1: none.
+    const std::vector<DividendSchedule> schedules{
+        {{0.6, 0.1, -0.15, 0.35, 0.85}, {0.45, 0.45, 0.45, 0.45, 0.45}},
+        {{}, {}},
+    };
+    const EscrowedDividends dividends(schedules, YieldCurve::flat(r));
+    assert(dividends.underlyings() == 2);
+    assert(dividends.present_value(0, 0.05) == 0.0 && dividends.present_value(1, 5.0) == 0.0);
+    const double pv_two = 0.45 * std::exp(-r * 0.1) + 0.45 * std::exp(-r * 0.35);
+    assert(std::abs(dividends.present_value(0, 0.5) - pv_two) < 1e-15);
+    assert(std::abs(dividends.present_value(0, 0.35) - pv_two) < 1e-15 &&
+           "A dividend going ex on the expiry date is lost to the option");
+
+    ContractBatch book;
+    std::vector<std::uint32_t> underlying;
+    for (int i = 0; i < 12; ++i) {
+        book.push_back({100.0, 90.0 + 2.0 * i, r, 0.2, 0.08 * (i + 1),
+                        i % 3 == 0 ? OptionType::PUT : OptionType::CALL});
+        underlying.push_back(static_cast<std::uint32_t>(i % 2));
+    }
+    std::vector<double> prices(book.size());
+    PricingWorkspace ws;
+    price_batch_escrowed(book, underlying, dividends, prices, ws);
+    for (std::size_t i = 0; i < book.size(); ++i) {
+        const Contract c  = book.row(i);
+        const double spot = c.S - dividends.present_value(underlying[i], c.T);
+        const double ref  = price_option(spot, c.K, c.r, c.sigma, c.T, c.option_type);
+        assert(std::abs(prices[i] - ref) < 1e-12 && "Row must be priced on the escrowed spot");
+        if (underlying[i] == 1) {
+            assert(prices[i] == price_option(c.S, c.K, c.r, c.sigma, c.T, c.option_type) &&
+                   "Rows without dividends must match plain Black-Scholes");
+        }
+    }
+
+    ContractBatch pair;
+    pair.push_back({100.0, 100.0, r, 0.25, 1.0, OptionType::CALL});
+    pair.push_back({100.0, 100.0, r, 0.25, 1.0, OptionType::PUT});
+    const std::vector<std::uint32_t> first{0, 0};
+    std::vector<double> cp(2);
+    price_batch_escrowed(pair, first, dividends, cp, ws);
+    const double parity = 100.0 - dividends.present_value(0, 1.0) - 100.0 * std::exp(-r);
+    assert(std::abs(cp[0] - cp[1] - parity) < 1e-10 && "Parity must hold net of dividends");
+
+    const std::vector<std::uint32_t> unknown{0, 2};
+    bool rejected = false;
+    try {
+        price_batch_escrowed(pair, unknown, dividends, cp, ws);
+    } catch (const std::out_of_range&) {
+        rejected = true;
+    }
+    assert(rejected && "An underlying without a schedule must be rejected");
+
+    // A NaN ex-time would break the sort and the running PV; infinities are rejected too.
+    for (const double bad : {std::nan(""), HUGE_VAL, -HUGE_VAL}) {
+        const std::vector<DividendSchedule> schedule{{{0.5, bad}, {1.0, 1.0}}};
+        rejected = false;
+        try {
+            EscrowedDividends invalid(schedule, YieldCurve::flat(r));
+        } catch (const std::invalid_argument&) {
+            rejected = true;
+        }
+        assert(rejected && "Non-finite ex-times must be rejected");
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Test 25: A throwing task surfaces on the caller after every worker has finished, and
+// the pool stays usable
+// ---------------------------------------------------------------------------
+static void test_pool_task_exceptions() {
+    for (const PoolWait wait : {PoolWait::BLOCK, PoolWait::SPIN}) {
+        PoolOptions options;
+        options.threads = 4;
+        options.wait    = wait;
+        ThreadPool pool(options);
+        for (int round = 0; round < 50; ++round) {
+            std::atomic<int> ran{0};
+            bool caught = false;
+            try {
+                pool.parallel_for(64, [&](std::size_t i) {
+                    ran.fetch_add(1);
+                    if (i % 7 == 3) {
+                        throw std::runtime_error("task " + std::to_string(i));
+                    }
+                });
+            } catch (const std::runtime_error&) {
+                caught = true;
+            }
+            assert(caught && "A task's exception must reach the caller");
+            assert(ran.load() >= 1 && ran.load() <= 64);
+
+            std::vector<int> hits(64, 0);
+            pool.parallel_for(hits.size(), [&](std::size_t i) { ++hits[i]; });
+            for (const int h : hits) {
+                assert(h == 1 && "The pool must run the next job normally");
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Test 26: SnapshotReader row ranges match load_snapshot for any chunking, and reading
+// past the end is rejected
+// ---------------------------------------------------------------------------
+static void test_snapshot_reader() {
+    const char* path = "test_reader_snapshot.bin";
+    RiskSnapshot snapshot;
+    for (std::size_t i = 0; i < 1000; ++i) {
+        const double x = static_cast<double>(i);
+        snapshot.inputs.push_back({90.0 + 0.02 * x, 80.0 + 0.04 * x, 0.01 + 1e-5 * x,
+                                   0.1 + 3e-4 * x, 0.05 + 2e-3 * x,
+                                   i % 3 == 0 ? OptionType::PUT : OptionType::CALL});
+    }
+    snapshot.prices = price_batch(snapshot.inputs);
+    save_snapshot(path, snapshot);
+    const RiskSnapshot full = load_snapshot(path);
+
+    SnapshotReader reader(path);
+    assert(reader.size() == full.prices.size());
+    ContractBatch batch;
+    Column<double> prices;
+    for (const std::size_t chunk : {std::size_t{1}, std::size_t{97}, std::size_t{1000}}) {
+        for (std::size_t offset = 0; offset < reader.size(); offset += chunk) {
+            const std::size_t count = std::min(chunk, reader.size() - offset);
+            reader.read(offset, count, batch, &prices);
+            assert(batch.size() == count && prices.size() == count);
+            for (std::size_t i = 0; i < count; ++i) {
+                const Contract want = full.inputs.row(offset + i);
+                const Contract got  = batch.row(i);
+                assert(got.S == want.S && got.K == want.K && got.r == want.r &&
+                       got.sigma == want.sigma && got.T == want.T &&
+                       got.option_type == want.option_type &&
+                       "Reader rows must match load_snapshot");
+                assert(prices[i] == full.prices[offset + i]);
+            }
+        }
+    }
+    reader.read(500, 0, batch);
+    assert(batch.size() == 0 && "An empty range must yield an empty batch");
+
+    bool threw = false;
+    try {
+        reader.read(990, 11, batch);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw && "A range past the end must throw std::out_of_range");
+    std::remove(path);
+}
+
 int main() {
     test_call_put_parity();
     test_deep_itm_delta();
     test_deep_otm_delta();
     test_vega_symmetry();
+    test_strategy_leg_dedup();
+    test_batch_dedup();
+    test_price_cache();
+    test_pricing_graph_dirty_tracking();
+    test_risk_aggregator();
+    test_incremental_eod();
+    test_deterministic_reduction();
+    test_arena_and_pool();
+    test_streaming_batch_matches_plain();
+    test_guarded_degenerate_rows();
+    test_time_decay_ladder();
+    test_parameter_grid();
+    test_shared_pool_and_cache_clear();
+    test_shared_batch_across_processes();
+    test_iv_surface();
+    test_sharded_coordinator();
+    test_spin_pool();
+    test_warm_state();
+    test_yield_curves();
+    test_escrowed_dividends();
+    test_pool_task_exceptions();
+    test_snapshot_reader();
     std::puts("All tests passed.");
     return 0;
 }
@@ -0,0 +1,95 @@
+"""
+Checks the op.price / op.greeks ufuncs against the batch API.
+
+Every ufunc loop (float32/float64 inputs, integer/OptionType codes) is called with
+broadcast inputs and compared element by element with price_batch / greeks_batch on the
+same rows flattened into a ContractBatch. Registered with CTest when the module is built
+with NumPy; run by hand with the module on PYTHONPATH:
+    PYTHONPATH=python python3 tests/test_ufuncs.py
+"""
+
+import sys
+
+import numpy as np
+
+import options_pricer as op
+
+GREEKS = ("delta", "gamma", "vega", "theta")
+
+
+def batch_of(S, K, r, sigma, T, option_type) -> "op.ContractBatch":
+    columns = [np.ravel(c) for c in np.broadcast_arrays(S, K, r, sigma, T, option_type)]
+    batch = op.ContractBatch()
+    batch.extend(S=columns[0], K=columns[1], r=columns[2], sigma=columns[3], T=columns[4],
+                 option_type=columns[5].astype(np.int32))
+    return batch
+
+
+def test_broadcast_double():
+    S = np.linspace(80.0, 120.0, 5).reshape(5, 1)
+    K = np.array([[90.0, 100.0, 110.0, 120.0]])
+    sigma = np.array([0.15, 0.2, 0.3, 0.45])
+    codes = (np.arange(5) % 2).reshape(5, 1)
+    r, T = 0.03, 0.75
+
+    prices = op.price(S, K, r, sigma, T, codes)
+    assert prices.shape == (5, 4) and prices.dtype == np.float64
+
+    batch = batch_of(S, K, r, sigma, T, codes)
+    np.testing.assert_allclose(prices.ravel(), op.price_batch(batch), rtol=0, atol=1e-12)
+
+    greeks = op.greeks(S, K, r, sigma, T, codes)
+    expected = op.greeks_batch(batch)
+    assert len(greeks) == 4
+    for name, values in zip(GREEKS, greeks):
+        assert values.shape == (5, 4)
+        np.testing.assert_allclose(values.ravel(), expected[name], rtol=0, atol=1e-12)
+
+
+def test_float32_loop():
+    S = np.array([95.0, 100.0, 105.0], dtype=np.float32)
+    K = np.float32(100.0)
+    prices = op.price(S, K, np.float32(0.05), np.float32(0.25), np.float32(1.0), 0)
+    assert prices.dtype == np.float32
+
+    batch = batch_of(S.astype(np.float64), 100.0, 0.05, 0.25, 1.0, 0)
+    np.testing.assert_allclose(prices, op.price_batch(batch), rtol=1e-5)
+
+    delta, gamma, vega, theta = op.greeks(S, K, np.float32(0.05), np.float32(0.25),
+                                          np.float32(1.0), 0)
+    assert delta.dtype == np.float32
+    np.testing.assert_allclose(delta, op.greeks_batch(batch)["delta"], rtol=1e-5)
+
+
+def test_option_type_objects():
+    types = np.array([op.OptionType.CALL, op.OptionType.PUT], dtype=object)
+    prices = op.price(100.0, np.array([[95.0], [105.0]]), 0.05, 0.2, 0.5, types)
+    assert prices.shape == (2, 2)
+
+    batch = batch_of(100.0, np.array([[95.0], [105.0]]), 0.05, 0.2, 0.5, np.array([0, 1]))
+    np.testing.assert_allclose(prices.ravel(), op.price_batch(batch), rtol=0, atol=1e-12)
+
+
+def test_invalid_type_and_out():
+    prices = op.price(100.0, 100.0, 0.05, 0.2, 1.0, np.array([0, 7, 1]))
+    assert np.isfinite(prices[0]) and np.isnan(prices[1]) and np.isfinite(prices[2])
+
+    out = np.empty(3)
+    result = op.price(np.array([90.0, 100.0, 110.0]), 100.0, 0.05, 0.2, 1.0, 1, out=out)
+    assert result is out
+    batch = batch_of(np.array([90.0, 100.0, 110.0]), 100.0, 0.05, 0.2, 1.0, 1)
+    np.testing.assert_allclose(out, op.price_batch(batch), rtol=0, atol=1e-12)
+
+
+def main() -> int:
+    tests = [test_broadcast_double, test_float32_loop, test_option_type_objects,
+             test_invalid_type_and_out]
+    for test in tests:
+        test()
+        print(f"{test.__name__}: ok")
+    print("All ufunc tests passed.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,656 @@
+// opx: batch pricing from the command line, for cron jobs and shell pipelines.
+//
+// Reads contracts from CSV (file or stdin) or a risk snapshot file, computes prices,
+// Greeks and/or implied vols chunk by chunk on a thread pool, and writes CSV, TSV or raw
+// float64 rows. Memory is bounded by the chunk size, so inputs may exceed RAM. Per-stage
+// timings and throughput go to stderr.
+
+#include "../src/batch_pricer.hpp"
+#include "../src/black_scholes.hpp"
+#include "../src/eod_risk.hpp"
+#include "../src/thread_pool.hpp"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr const char* USAGE = R"(usage: opx [options] [INPUT]
+
+Price option contracts in chunks. INPUT is a CSV file, a risk snapshot written by
+save_snapshot, or '-' / omitted for CSV on stdin.
+
+CSV input: one contract per line. If the first non-blank line does not start with a
+number it is a header, and columns are matched by name (S|spot, K|strike, r|rate,
+sigma|vol, T|expiry, type|option_type, price|mid); without one they are positional:
+S,K,r,sigma,T,type[,price]. type is C/P, call/put or 0/1.
+A snapshot supplies its stored prices as the market price for --iv.
+
+options:
+  -c, --compute LIST   comma-separated outputs: price, greeks, iv (default: price)
+  -m, --model NAME     bs (default) or guarded: finite intrinsic-value prices for
+                       expired, zero-vol or far-from-the-money rows (prices only)
+  -j, --threads N      pricing threads including the main one (default: all cores)
+  -f, --format FMT     output: csv (default), tsv, or binary (native float64 rows)
+  -i, --input-format F csv or snapshot (default: detect from the header
+                       of a regular file; pipes are read as CSV)
+  -o, --output FILE    write results to FILE instead of stdout
+  -n, --chunk ROWS     rows per chunk (default: 65536)
+  -q, --quiet          no timing report on stderr
+  -h, --help           show this help
+
+Output has one row per input row with the selected columns in the order
+price, delta, gamma, vega, theta, iv; unsolvable IVs are written as nan.)";
+
+constexpr std::size_t ROWS_PER_TASK = 8192; ///< Rows per thread-pool task within a chunk
+
+enum class InputFormat { AUTO, CSV, SNAPSHOT };
+enum class OutputFormat { CSV, TSV, BINARY };
+enum class Model { BS, GUARDED };
+
+struct Options {
+    std::string input          = "-";
+    std::string output         = "-";
+    InputFormat input_format   = InputFormat::AUTO;
+    OutputFormat output_format = OutputFormat::CSV;
+    Model model                = Model::BS;
+    bool price                 = false;
+    bool greeks                = false;
+    bool iv                    = false;
+    unsigned threads           = 0;
+    std::size_t chunk          = std::size_t{1} << 16;
+    bool quiet                 = false;
+};
+
+/// Bad command line; reported with the usage hint and exit status 2.
+struct UsageError : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+using Clock = std::chrono::steady_clock;
+
+double ms_since(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+unsigned long parse_count(const std::string& value, const char* flag) {
+    char* end             = nullptr;
+    const unsigned long n = std::strtoul(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || n == 0) {
+        throw UsageError(std::string(flag) + " expects a positive integer, got '" + value + "'");
+    }
+    return n;
+}
+
+/// Parse a whole NUL-terminated field as a double; false if anything is left over.
+/// from_chars is locale-independent and several times faster than strtod where the
+/// library provides it for floating point.
+bool parse_double(const char* field, double& v) {
+#if defined(__cpp_lib_to_chars)
+    const char* first = field + (*field == '+');
+    const char* last  = first + std::strlen(first);
+    const auto result = std::from_chars(first, last, v);
+    return result.ec == std::errc() && result.ptr == last && first != last;
+#else
+    char* end = nullptr;
+    v         = std::strtod(field, &end);
+    return end != field && *end == '\0';
+#endif
+}
+
+/// Shortest decimal that reads back as `v`; `buf` holds at least 32 chars.
+std::size_t format_double(double v, char* buf) {
+#if defined(__cpp_lib_to_chars)
+    return static_cast<std::size_t>(std::to_chars(buf, buf + 32, v).ptr - buf);
+#else
+    return static_cast<std::size_t>(std::snprintf(buf, 32, "%.17g", v));
+#endif
+}
+
+Options parse_args(int argc, char** argv) {
+    Options opt;
+    bool have_input = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto value      = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw UsageError(arg + " expects a value");
+            }
+            return argv[++i];
+        };
+
+        if (arg == "-h" || arg == "--help") {
+            std::puts(USAGE);
+            std::exit(0);
+        } else if (arg == "-c" || arg == "--compute") {
+            std::string list = value() + ",";
+            for (std::size_t pos = 0, comma; (comma = list.find(',', pos)) != std::string::npos;
+                 pos = comma + 1) {
+                const std::string item = lower(list.substr(pos, comma - pos));
+                if (item == "price") {
+                    opt.price = true;
+                } else if (item == "greeks") {
+                    opt.greeks = true;
+                } else if (item == "iv") {
+                    opt.iv = true;
+                } else {
+                    throw UsageError("unknown output '" + item + "' (price, greeks, iv)");
+                }
+            }
+        } else if (arg == "-m" || arg == "--model") {
+            const std::string m = lower(value());
+            if (m == "bs") {
+                opt.model = Model::BS;
+            } else if (m == "guarded") {
+                opt.model = Model::GUARDED;
+            } else {
+                throw UsageError("unknown model '" + m + "' (bs, guarded)");
+            }
+        } else if (arg == "-j" || arg == "--threads") {
+            opt.threads = static_cast<unsigned>(parse_count(value(), "--threads"));
+        } else if (arg == "-f" || arg == "--format") {
+            const std::string f = lower(value());
+            if (f == "csv") {
+                opt.output_format = OutputFormat::CSV;
+            } else if (f == "tsv") {
+                opt.output_format = OutputFormat::TSV;
+            } else if (f == "binary") {
+                opt.output_format = OutputFormat::BINARY;
+            } else {
+                throw UsageError("unknown output format '" + f + "' (csv, tsv, binary)");
+            }
+        } else if (arg == "-i" || arg == "--input-format") {
+            const std::string f = lower(value());
+            if (f == "csv") {
+                opt.input_format = InputFormat::CSV;
+            } else if (f == "snapshot") {
+                opt.input_format = InputFormat::SNAPSHOT;
+            } else {
+                throw UsageError("unknown input format '" + f + "' (csv, snapshot)");
+            }
+        } else if (arg == "-o" || arg == "--output") {
+            opt.output = value();
+        } else if (arg == "-n" || arg == "--chunk") {
+            opt.chunk = parse_count(value(), "--chunk");
+        } else if (arg == "-q" || arg == "--quiet") {
+            opt.quiet = true;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            throw UsageError("unknown option " + arg);
+        } else if (have_input) {
+            throw UsageError("more than one input file");
+        } else {
+            opt.input  = arg;
+            have_input = true;
+        }
+    }
+    if (!opt.price && !opt.greeks && !opt.iv) {
+        opt.price = true;
+    }
+    return opt;
+}
+
+// ---------------------------------------------------------------------------
+// Inputs: each source fills a reused ContractBatch (plus market prices) per chunk
+// ---------------------------------------------------------------------------
+
+/// Streaming CSV reader over a FILE*.
+class CsvSource {
+  public:
+    CsvSource(std::FILE* in, std::string name, bool need_price)
+        : in_(in), name_(std::move(name)), need_price_(need_price) {}
+
+    ~CsvSource() { std::free(line_); }
+
+    CsvSource(const CsvSource&)            = delete;
+    CsvSource& operator=(const CsvSource&) = delete;
+
+    /// Up to max_rows contracts into batch/market; false once the input is exhausted.
+    bool next(std::size_t max_rows, ContractBatch& batch, Column<double>& market) {
+        batch.clear();
+        market.clear();
+        while (batch.size() < max_rows && read_line()) {
+            if (blank()) {
+                continue;
+            }
+            if (first_line_) {
+                first_line_ = false;
+                if (!looks_numeric()) {
+                    map_header();
+                    continue;
+                }
+            }
+            parse_row(batch, market);
+        }
+        return batch.size() > 0;
+    }
+
+  private:
+    enum Field { S, K, R, SIGMA, T, TYPE, PRICE, FIELDS };
+
+    bool read_line() {
+        const ssize_t len = ::getline(&line_, &cap_, in_);
+        if (len < 0) {
+            if (std::ferror(in_)) {
+                throw std::runtime_error(name_ + ": read error");
+            }
+            return false;
+        }
+        ++line_no_;
+        return true;
+    }
+
+    bool blank() const {
+        for (const char* p = line_; *p != '\0'; ++p) {
+            if (!std::isspace(static_cast<unsigned char>(*p))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool looks_numeric() const {
+        const char* p = line_;
+        while (*p == ' ' || *p == '\t') {
+            ++p;
+        }
+        return std::isdigit(static_cast<unsigned char>(*p)) || *p == '-' || *p == '+' ||
+               *p == '.';
+    }
+
+    /// Split the current line on commas in place; fields_ points into line_.
+    void split() {
+        fields_.clear();
+        char* p = line_;
+        while (true) {
+            while (*p == ' ' || *p == '\t') {
+                ++p;
+            }
+            fields_.push_back(p);
+            char* end = p + std::strcspn(p, ",\r\n");
+            const bool last = *end != ',';
+            char* trim      = end;
+            while (trim > p && (trim[-1] == ' ' || trim[-1] == '\t')) {
+                --trim;
+            }
+            *trim = '\0';
+            if (last) {
+                break;
+            }
+            p = end + 1;
+        }
+    }
+
+    void map_header() {
+        split();
+        std::fill(column_, column_ + FIELDS, -1);
+        for (std::size_t i = 0; i < fields_.size(); ++i) {
+            const std::string name = lower(fields_[i]);
+            const int f = name == "s" || name == "spot"               ? S
+                          : name == "k" || name == "strike"           ? K
+                          : name == "r" || name == "rate"             ? R
+                          : name == "sigma" || name == "vol"          ? SIGMA
+                          : name == "t" || name == "expiry"           ? T
+                          : name == "type" || name == "option_type"   ? TYPE
+                          : name == "price" || name == "mid"          ? PRICE
+                                                                      : -1;
+            if (f >= 0) {
+                column_[f] = static_cast<int>(i);
+            }
+        }
+        const char* names[] = {"S", "K", "r", "sigma", "T", "type", "price"};
+        for (int f = 0; f < (need_price_ ? FIELDS : PRICE); ++f) {
+            if (column_[f] < 0) {
+                throw std::runtime_error(name_ + ": header has no '" + names[f] + "' column");
+            }
+        }
+    }
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error(name_ + ":" + std::to_string(line_no_) + ": " + what);
+    }
+
+    double number(int f) const {
+        const int col = column_[f];
+        if (col < 0 || static_cast<std::size_t>(col) >= fields_.size()) {
+            fail("missing column " + std::to_string(col + 1));
+        }
+        double v = 0.0;
+        if (!parse_double(fields_[col], v)) {
+            fail(std::string("not a number: '") + fields_[col] + "'");
+        }
+        return v;
+    }
+
+    OptionType option_type() const {
+        const int col = column_[TYPE];
+        if (col < 0 || static_cast<std::size_t>(col) >= fields_.size()) {
+            fail("missing option type");
+        }
+        const std::string t = lower(fields_[col]);
+        if (t == "c" || t == "call" || t == "0") {
+            return OptionType::CALL;
+        }
+        if (t == "p" || t == "put" || t == "1") {
+            return OptionType::PUT;
+        }
+        fail("option type must be C/P, call/put or 0/1, got '" + t + "'");
+    }
+
+    void parse_row(ContractBatch& batch, Column<double>& market) {
+        split();
+        batch.push_back({number(S), number(K), number(R), number(SIGMA), number(T),
+                         option_type()});
+        if (need_price_) {
+            market.push_back(number(PRICE));
+        }
+    }
+
+    std::FILE* in_;
+    std::string name_;
+    bool need_price_;
+    char* line_          = nullptr;
+    std::size_t cap_     = 0;
+    std::size_t line_no_ = 0;
+    bool first_line_     = true; ///< No non-blank line seen yet: it may be the header
+    std::vector<char*> fields_;
+    int column_[FIELDS] = {0, 1, 2, 3, 4, 5, 6}; ///< Field -> CSV column; positional default
+};
+
+/// Chunked reader over a risk snapshot file.
+class SnapshotSource {
+  public:
+    SnapshotSource(const std::string& path, bool need_price)
+        : reader_(path), need_price_(need_price) {}
+
+    bool next(std::size_t max_rows, ContractBatch& batch, Column<double>& market) {
+        const std::size_t count = std::min(max_rows, reader_.size() - offset_);
+        reader_.read(offset_, count, batch, need_price_ ? &market : nullptr);
+        offset_ += count;
+        return count > 0;
+    }
+
+  private:
+    SnapshotReader reader_;
+    bool need_price_;
+    std::size_t offset_ = 0;
+};
+
+/// Only regular files are probed: opening a pipe or FIFO to read the header would consume
+/// bytes the CSV reader then never sees.
+bool is_snapshot(const std::string& path) {
+    struct stat st {};
+    if (path == "-" || ::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+    try {
+        SnapshotReader probe(path);
+        return true;
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Compute and output
+// ---------------------------------------------------------------------------
+
+/// Per-chunk results, reused across chunks.
+struct Results {
+    Column<double> prices;
+    Column<Greeks> greeks;
+    Column<double> ivs;
+};
+
+/// Milliseconds spent per stage, summed over chunks.
+struct StageTimes {
+    double read   = 0.0;
+    double price  = 0.0;
+    double greeks = 0.0;
+    double iv     = 0.0;
+    double write  = 0.0;
+};
+
+/// Run body(view, begin, end) over the chunk in ROWS_PER_TASK pieces on the pool.
+template <typename Body> void for_tasks(ThreadPool& pool, const BatchView& view, const Body& body) {
+    const std::size_t n     = view.size();
+    const std::size_t tasks = (n + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+    pool.parallel_for(tasks, [&](std::size_t t) {
+        const std::size_t begin = t * ROWS_PER_TASK;
+        const std::size_t end   = std::min(n, begin + ROWS_PER_TASK);
+        body(view.slice(begin, end - begin), begin);
+    });
+}
+
+void compute(const Options& opt, const BatchView& view, const Column<double>& market,
+             ThreadPool& pool, Results& out, StageTimes& times) {
+    const std::size_t n = view.size();
+    if (opt.price) {
+        const auto t0 = Clock::now();
+        out.prices.resize(n);
+        for_tasks(pool, view, [&](const BatchView& part, std::size_t begin) {
+            const Span<double> dst = Span<double>(out.prices).subspan(begin, part.size());
+            if (opt.model == Model::GUARDED) {
+                price_batch_guarded(part, dst);
+            } else {
+                price_batch(part, dst);
+            }
+        });
+        times.price += ms_since(t0);
+    }
+    if (opt.greeks) {
+        const auto t0 = Clock::now();
+        out.greeks.resize(n);
+        for_tasks(pool, view, [&](const BatchView& part, std::size_t begin) {
+            greeks_batch(part, Span<Greeks>(out.greeks).subspan(begin, part.size()));
+        });
+        times.greeks += ms_since(t0);
+    }
+    if (opt.iv) {
+        const auto t0 = Clock::now();
+        out.ivs.resize(n);
+        for_tasks(pool, view, [&](const BatchView& part, std::size_t begin) {
+            for (std::size_t i = 0; i < part.size(); ++i) {
+                out.ivs[begin + i] = implied_vol(market[begin + i], part.S[i], part.K[i],
+                                                 part.r[i], part.T[i], part.option_type[i]);
+            }
+        });
+        times.iv += ms_since(t0);
+    }
+}
+
+/// Selected output values of row i, in column order.
+std::size_t row_values(const Options& opt, const Results& res, std::size_t i, double* v) {
+    std::size_t k = 0;
+    if (opt.price) {
+        v[k++] = res.prices[i];
+    }
+    if (opt.greeks) {
+        const Greeks& g = res.greeks[i];
+        v[k++]          = g.delta;
+        v[k++]          = g.gamma;
+        v[k++]          = g.vega;
+        v[k++]          = g.theta;
+    }
+    if (opt.iv) {
+        v[k++] = res.ivs[i];
+    }
+    return k;
+}
+
+void write_header(const Options& opt, std::FILE* out) {
+    if (opt.output_format == OutputFormat::BINARY) {
+        return;
+    }
+    const char sep = opt.output_format == OutputFormat::TSV ? '\t' : ',';
+    std::string header;
+    const auto add = [&](const char* name) {
+        if (!header.empty()) {
+            header += sep;
+        }
+        header += name;
+    };
+    if (opt.price) {
+        add("price");
+    }
+    if (opt.greeks) {
+        add("delta");
+        add("gamma");
+        add("vega");
+        add("theta");
+    }
+    if (opt.iv) {
+        add("iv");
+    }
+    header += '\n';
+    std::fwrite(header.data(), 1, header.size(), out);
+}
+
+void write_chunk(const Options& opt, const Results& res, std::size_t n, std::FILE* out,
+                 std::string& buffer) {
+    double values[6];
+    if (opt.output_format == OutputFormat::BINARY) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t k = row_values(opt, res, i, values);
+            std::fwrite(values, sizeof(double), k, out);
+        }
+        return;
+    }
+
+    const char sep = opt.output_format == OutputFormat::TSV ? '\t' : ',';
+    buffer.clear();
+    char field[32];
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::size_t k = row_values(opt, res, i, values);
+        for (std::size_t j = 0; j < k; ++j) {
+            buffer.append(field, format_double(values[j], field));
+            buffer += j + 1 < k ? sep : '\n';
+        }
+    }
+    std::fwrite(buffer.data(), 1, buffer.size(), out);
+}
+
+void report(const Options& opt, const StageTimes& t, double total_ms, std::size_t rows,
+            std::size_t chunks, unsigned threads) {
+    std::fprintf(stderr, "opx: %zu rows in %zu chunk(s) of <= %zu, %u thread(s), model %s\n",
+                 rows, chunks, opt.chunk, threads, opt.model == Model::GUARDED ? "guarded" : "bs");
+    std::fprintf(stderr, "  %-8s %12s %14s\n", "stage", "ms", "rows/sec");
+    const auto line = [&](const char* name, double ms) {
+        const double rate = ms > 0.0 ? static_cast<double>(rows) / (ms / 1e3) : 0.0;
+        std::fprintf(stderr, "  %-8s %12.2f %14.0f\n", name, ms, rate);
+    };
+    line("read", t.read);
+    if (opt.price) {
+        line("price", t.price);
+    }
+    if (opt.greeks) {
+        line("greeks", t.greeks);
+    }
+    if (opt.iv) {
+        line("iv", t.iv);
+    }
+    line("write", t.write);
+    line("total", total_ms);
+}
+
+template <typename Source>
+void run(const Options& opt, Source& source, std::FILE* out, ThreadPool& pool) {
+    ContractBatch batch;
+    Column<double> market;
+    Results results;
+    StageTimes times;
+    std::string buffer;
+    std::size_t rows   = 0;
+    std::size_t chunks = 0;
+
+    const auto start = Clock::now();
+    write_header(opt, out);
+    while (true) {
+        auto t0           = Clock::now();
+        const bool more   = source.next(opt.chunk, batch, market);
+        times.read       += ms_since(t0);
+        if (!more) {
+            break;
+        }
+
+        compute(opt, batch, market, pool, results, times);
+
+        t0 = Clock::now();
+        write_chunk(opt, results, batch.size(), out, buffer);
+        times.write += ms_since(t0);
+
+        rows += batch.size();
+        ++chunks;
+    }
+    const auto t0 = Clock::now();
+    if (std::fflush(out) != 0 || std::ferror(out)) {
+        throw std::runtime_error("write failed: " + opt.output);
+    }
+    times.write += ms_since(t0);
+
+    if (!opt.quiet) {
+        report(opt, times, ms_since(start), rows, chunks, pool.size());
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    try {
+        opt = parse_args(argc, argv);
+    } catch (const UsageError& e) {
+        std::fprintf(stderr, "opx: %s\nTry 'opx --help'.\n", e.what());
+        return 2;
+    }
+
+    try {
+        std::FILE* out = opt.output == "-" ? stdout : std::fopen(opt.output.c_str(), "wb");
+        if (out == nullptr) {
+            throw std::runtime_error("cannot open " + opt.output + ": " + std::strerror(errno));
+        }
+        std::setvbuf(out, nullptr, _IOFBF, 1 << 20);
+
+        ThreadPool pool(opt.threads);
+        const bool snapshot = opt.input_format == InputFormat::SNAPSHOT ||
+                              (opt.input_format == InputFormat::AUTO && is_snapshot(opt.input));
+        if (snapshot) {
+            SnapshotSource source(opt.input, opt.iv);
+            run(opt, source, out, pool);
+        } else {
+            std::FILE* in = opt.input == "-" ? stdin : std::fopen(opt.input.c_str(), "r");
+            if (in == nullptr) {
+                throw std::runtime_error("cannot open " + opt.input + ": " + std::strerror(errno));
+            }
+            CsvSource source(in, opt.input == "-" ? "<stdin>" : opt.input, opt.iv);
+            run(opt, source, out, pool);
+            if (in != stdin) {
+                std::fclose(in);
+            }
+        }
+        if (out != stdout) {
+            std::fclose(out);
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "opx: error: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}